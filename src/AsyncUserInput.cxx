@@ -24,8 +24,15 @@
 #include "GlobalBindings.hxx"
 #include "ncmpc.hxx"
 #include "Point.hxx"
+#include "PerfStats.hxx"
 #include "util/Compiler.h"
 
+/**
+ * The maximum number of pending keys handled before the screen is
+ * updated.
+ */
+static constexpr unsigned MAX_INPUT_BATCH = 64;
+
 static bool
 ignore_key(int key)
 {
@@ -39,20 +46,18 @@ translate_key(int key)
 	return GetGlobalKeyBindings().FindKey(key);
 }
 
-void
-AsyncUserInput::OnReadable(const boost::system::error_code &error)
+int
+AsyncUserInput::GetPendingKey() noexcept
 {
-	if (error) {
-		get_io_context().stop();
-		return;
-	}
-
-	int key = wgetch(&w);
-	if (ignore_key(key)) {
-		AsyncWait();
-		return;
-	}
+	nodelay(&w, true);
+	const int key = wgetch(&w);
+	nodelay(&w, false);
+	return key;
+}
 
+bool
+AsyncUserInput::HandleKey(int key)
+{
 #ifdef HAVE_GETMOUSE
 	if (key == KEY_MOUSE) {
 		MEVENT event;
@@ -64,27 +69,62 @@ AsyncUserInput::OnReadable(const boost::system::error_code &error)
 		getmouse(&event);
 #endif
 
-		begin_input_event();
 		do_mouse_event({event.x, event.y}, event.bstate);
-		end_input_event();
-
-		AsyncWait();
-		return;
+		return true;
 	}
 #endif
 
 	Command cmd = translate_key(key);
-	if (cmd == Command::NONE) {
-		AsyncWait();
+	if (cmd == Command::NONE)
+		return true;
+
+	return do_input_event(get_io_context(), cmd);
+}
+
+void
+AsyncUserInput::OnReadable(const boost::system::error_code &error)
+{
+	if (error) {
+		get_io_context().stop();
 		return;
 	}
 
-	begin_input_event();
+	/* read the clock only while the "perf" page is being used */
+	const bool measure = perf_stats.enabled;
+	std::chrono::steady_clock::time_point arrival;
+	if (measure)
+		arrival = std::chrono::steady_clock::now();
+
+	bool handled = false;
+
+	/* handle all keys (and mouse events) which are already
+	   pending before updating the screen once; this way, a key
+	   which is held down (or a burst of mouse wheel events)
+	   doesn't pile up a backlog of screen updates */
+	for (unsigned i = 0; i < MAX_INPUT_BATCH; ++i) {
+		const int key = i == 0 ? wgetch(&w) : GetPendingKey();
+		if (key == ERR)
+			break;
+
+		if (ignore_key(key))
+			continue;
+
+		if (!handled) {
+			begin_input_event();
+			handled = true;
+		}
+
+		if (!HandleKey(key))
+			return;
+	}
 
-	if (!do_input_event(get_io_context(), cmd))
-		return;
+	if (handled) {
+		end_input_event();
+
+		if (measure)
+			perf_stats.input_latency.Add(std::chrono::steady_clock::now() - arrival);
+	}
 
-	end_input_event();
 	AsyncWait();
 }
 
@@ -36,6 +36,18 @@ private:
 					       std::placeholders::_1));
 	}
 
+	/**
+	 * Read a key without blocking.
+	 *
+	 * @return the key or ERR if there is none
+	 */
+	int GetPendingKey() noexcept;
+
+	/**
+	 * @return false if the application shall quit
+	 */
+	bool HandleKey(int key);
+
 	void OnReadable(const boost::system::error_code &error);
 };
 
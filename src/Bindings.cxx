@@ -49,10 +49,8 @@ KeyBindings::GetKeyNames(Command command) const noexcept
 }
 
 Command
-KeyBindings::FindKey(int key) const noexcept
+KeyBindings::ScanKey(int key) const noexcept
 {
-	assert(key != 0);
-
 	for (size_t i = 0; i < size_t(Command::NONE); ++i) {
 		if (key_bindings[i].HasKey(key))
 			return Command(i);
@@ -61,6 +59,45 @@ KeyBindings::FindKey(int key) const noexcept
 	return Command::NONE;
 }
 
+void
+KeyBindings::BuildKeyTable() const noexcept
+{
+	key_table.fill(Command::NONE);
+
+	/* walk backwards, so the first command wins if a key is
+	   bound to more than one (like ScanKey() does) */
+	for (size_t i = size_t(Command::NONE); i-- > 0;)
+		for (const auto key : key_bindings[i].keys)
+			if (key > 0 && key < KEY_TABLE_SIZE)
+				key_table[key] = Command(i);
+
+	key_table_valid = true;
+}
+
+Command
+KeyBindings::FindKey(int key) const noexcept
+{
+	assert(key != 0);
+
+	if (key < 0 || key >= KEY_TABLE_SIZE)
+		return ScanKey(key);
+
+	if (!key_table_valid)
+		BuildKeyTable();
+
+	return key_table[key];
+}
+
+bool
+KeyBindings::HasSameKeys(const KeyBindings &other) const noexcept
+{
+	for (size_t i = 0; i < size_t(Command::NONE); ++i)
+		if (key_bindings[i].keys != other.key_bindings[i].keys)
+			return false;
+
+	return true;
+}
+
 #ifndef NCMPC_MINI
 
 bool
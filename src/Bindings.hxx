@@ -36,6 +36,13 @@
 
 #define MAX_COMMAND_KEYS 3
 
+/**
+ * Key codes below this value are looked up in
+ * KeyBindings::key_table; this covers all single-byte characters and
+ * the curses KEY_* codes.
+ */
+static constexpr int KEY_TABLE_SIZE = 0x200;
+
 struct KeyBinding {
 	std::array<int, MAX_COMMAND_KEYS> keys;
 
@@ -73,9 +80,28 @@ struct KeyBinding {
 struct KeyBindings {
 	std::array<KeyBinding, size_t(Command::NONE)> key_bindings;
 
+	/**
+	 * Maps key codes to commands, so FindKey() doesn't need to
+	 * scan all bindings on each key press.  It is built on
+	 * demand; call InvalidateKeyTable() after modifying
+	 * #key_bindings.
+	 */
+	mutable std::array<Command, KEY_TABLE_SIZE> key_table{};
+	mutable bool key_table_valid = false;
+
 	gcc_pure
 	Command FindKey(int key) const noexcept;
 
+	void InvalidateKeyTable() noexcept {
+		key_table_valid = false;
+	}
+
+	/**
+	 * Do both objects bind the same keys?
+	 */
+	gcc_pure
+	bool HasSameKeys(const KeyBindings &other) const noexcept;
+
 	/**
 	 * Returns the name of the first key bound to the given
 	 * command, or nullptr if there is no key binding.
@@ -90,10 +116,13 @@ struct KeyBindings {
 		    const std::array<int, MAX_COMMAND_KEYS> &keys) noexcept {
 		auto &b = key_bindings[size_t(command)];
 		b.SetKey(keys);
+		InvalidateKeyTable();
 	}
 
 #ifndef NCMPC_MINI
 	/**
+	 * Check for keys which are bound to more than one command.
+	 *
 	 * @return true on success, false on error
 	 */
 	bool Check(char *buf, size_t size) const noexcept;
@@ -103,6 +132,16 @@ struct KeyBindings {
 	 */
 	bool WriteToFile(FILE *f, int all) const noexcept;
 #endif
+
+private:
+	/**
+	 * Linear search for the first command bound to the given
+	 * key.
+	 */
+	gcc_pure
+	Command ScanKey(int key) const noexcept;
+
+	void BuildKeyTable() const noexcept;
 };
 
 /* write key bindings flags */
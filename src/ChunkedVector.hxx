@@ -0,0 +1,341 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef CHUNKED_VECTOR_HXX
+#define CHUNKED_VECTOR_HXX
+
+#include "util/Compiler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * A sequence container which stores its items in a list of small
+ * chunks.  Positional access is a binary search over the chunk
+ * offsets, and inserting, erasing or moving an item only shifts the
+ * items of one chunk plus the offset table, instead of the whole
+ * sequence.
+ */
+template<typename T, size_t CHUNK_SIZE=256>
+class ChunkedVector {
+	using Chunk = std::vector<T>;
+
+	std::vector<Chunk> chunks;
+
+	/**
+	 * The position of the first item of each chunk.  This array
+	 * has the same length as #chunks.
+	 */
+	std::vector<size_t> offsets;
+
+	size_t n = 0;
+
+	/**
+	 * The chunk which was accessed most recently; this speeds up
+	 * sequential access (e.g. while painting a list).
+	 */
+	mutable size_t hint = 0;
+
+public:
+	using value_type = T;
+	using size_type = size_t;
+
+	template<bool CONST>
+	class Iterator {
+		friend class ChunkedVector;
+
+		using Chunks = typename std::conditional<CONST,
+							 const std::vector<Chunk>,
+							 std::vector<Chunk>>::type;
+
+		Chunks *chunks;
+		size_t chunk, i;
+
+		Iterator(Chunks &_chunks, size_t _chunk, size_t _i) noexcept
+			:chunks(&_chunks), chunk(_chunk), i(_i) {}
+
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = ptrdiff_t;
+		using pointer = typename std::conditional<CONST, const T *, T *>::type;
+		using reference = typename std::conditional<CONST, const T &, T &>::type;
+
+		bool operator==(const Iterator &other) const noexcept {
+			return chunk == other.chunk && i == other.i;
+		}
+
+		bool operator!=(const Iterator &other) const noexcept {
+			return !(*this == other);
+		}
+
+		Iterator &operator++() noexcept {
+			if (++i == (*chunks)[chunk].size()) {
+				++chunk;
+				i = 0;
+			}
+
+			return *this;
+		}
+
+		reference operator*() const noexcept {
+			return (*chunks)[chunk][i];
+		}
+
+		pointer operator->() const noexcept {
+			return &(*chunks)[chunk][i];
+		}
+	};
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	size_type size() const noexcept {
+		return n;
+	}
+
+	bool empty() const noexcept {
+		return n == 0;
+	}
+
+	void clear() noexcept {
+		chunks.clear();
+		offsets.clear();
+		n = 0;
+		hint = 0;
+	}
+
+	iterator begin() noexcept {
+		return {chunks, 0, 0};
+	}
+
+	iterator end() noexcept {
+		return {chunks, chunks.size(), 0};
+	}
+
+	const_iterator begin() const noexcept {
+		return {chunks, 0, 0};
+	}
+
+	const_iterator end() const noexcept {
+		return {chunks, chunks.size(), 0};
+	}
+
+	const T &operator[](size_type i) const noexcept {
+		const auto c = FindChunk(i);
+		return chunks[c][i - offsets[c]];
+	}
+
+	T &operator[](size_type i) noexcept {
+		const auto c = FindChunk(i);
+		return chunks[c][i - offsets[c]];
+	}
+
+	template<typename... Args>
+	void emplace_back(Args&&... args) {
+		if (chunks.empty() || chunks.back().size() >= CHUNK_SIZE) {
+			chunks.emplace_back();
+			chunks.back().reserve(CHUNK_SIZE);
+			offsets.push_back(n);
+		}
+
+		chunks.back().emplace_back(std::forward<Args>(args)...);
+		++n;
+	}
+
+	void push_back(T &&value) {
+		emplace_back(std::move(value));
+	}
+
+	/**
+	 * Insert a new item before the given position (which may be
+	 * equal to size()).
+	 */
+	void insert(size_type i, T &&value) {
+		assert(i <= n);
+
+		if (i == n) {
+			push_back(std::move(value));
+			return;
+		}
+
+		const auto c = FindChunk(i);
+		auto &chunk = chunks[c];
+		chunk.insert(std::next(chunk.begin(), i - offsets[c]),
+			     std::move(value));
+		++n;
+
+		if (chunk.size() >= 2 * CHUNK_SIZE)
+			Split(c);
+
+		UpdateOffsets(c);
+	}
+
+	/**
+	 * Remove the item at the given position and return it.
+	 */
+	T Take(size_type i) {
+		assert(i < n);
+
+		const auto c = FindChunk(i);
+		auto &chunk = chunks[c];
+		const auto p = std::next(chunk.begin(), i - offsets[c]);
+		T value = std::move(*p);
+		chunk.erase(p);
+		--n;
+
+		Compact(c);
+		return value;
+	}
+
+	void erase(size_type i) {
+		Take(i);
+	}
+
+	/**
+	 * Remove all items in the range [start, end).
+	 */
+	void erase(size_type start, size_type end) {
+		assert(start <= end);
+		assert(end <= n);
+
+		if (start == end)
+			return;
+
+		const size_type first = FindChunk(start);
+		size_type c = first, i = start - offsets[c];
+		size_type remaining = end - start;
+		n -= remaining;
+
+		while (remaining > 0) {
+			auto &chunk = chunks[c];
+			const size_type count = std::min(remaining,
+							 chunk.size() - i);
+			const auto b = std::next(chunk.begin(), i);
+			chunk.erase(b, std::next(b, count));
+			remaining -= count;
+
+			if (chunk.empty()) {
+				chunks.erase(std::next(chunks.begin(), c));
+				offsets.erase(std::next(offsets.begin(), c));
+			} else {
+				++c;
+				i = 0;
+			}
+		}
+
+		Compact(std::min(first, chunks.empty() ? 0 : chunks.size() - 1));
+	}
+
+	/**
+	 * Move the item at position #src to position #dest, shifting
+	 * all items in between by one.
+	 */
+	void Move(size_type dest, size_type src) {
+		assert(src < n);
+		assert(dest < n);
+
+		if (src != dest)
+			insert(dest, Take(src));
+	}
+
+private:
+	size_type FindChunk(size_type i) const noexcept {
+		assert(i < n);
+
+		if (hint < chunks.size() && i >= offsets[hint] &&
+		    i < offsets[hint] + chunks[hint].size())
+			return hint;
+
+		auto o = std::upper_bound(offsets.begin(), offsets.end(), i);
+		assert(o != offsets.begin());
+		return hint = std::distance(offsets.begin(), o) - 1;
+	}
+
+	/**
+	 * Recalculate all offsets after the given chunk.
+	 */
+	void UpdateOffsets(size_type c) noexcept {
+		for (++c; c < chunks.size(); ++c)
+			offsets[c] = offsets[c - 1] + chunks[c - 1].size();
+	}
+
+	/**
+	 * Split a chunk which has grown too large into two halves.
+	 */
+	void Split(size_type c) {
+		auto &chunk = chunks[c];
+		const auto middle = std::next(chunk.begin(), chunk.size() / 2);
+
+		Chunk tail;
+		tail.reserve(CHUNK_SIZE);
+		std::move(middle, chunk.end(), std::back_inserter(tail));
+		chunk.erase(middle, chunk.end());
+
+		chunks.insert(std::next(chunks.begin(), c + 1),
+			      std::move(tail));
+		offsets.insert(std::next(offsets.begin(), c + 1),
+			       offsets[c] + chunks[c].size());
+	}
+
+	/**
+	 * Called after items have been removed from the given chunk:
+	 * delete it if it has become empty, merge it with its
+	 * successor if both are small, and update the offsets.
+	 */
+	void Compact(size_type c) noexcept {
+		if (c >= chunks.size()) {
+			hint = 0;
+			return;
+		}
+
+		if (chunks[c].empty()) {
+			chunks.erase(std::next(chunks.begin(), c));
+			offsets.erase(std::next(offsets.begin(), c));
+			if (c > 0)
+				--c;
+		} else if (c + 1 < chunks.size() &&
+			   chunks[c].size() + chunks[c + 1].size() <= CHUNK_SIZE) {
+			auto &next = chunks[c + 1];
+			std::move(next.begin(), next.end(),
+				  std::back_inserter(chunks[c]));
+			chunks.erase(std::next(chunks.begin(), c + 1));
+			offsets.erase(std::next(offsets.begin(), c + 1));
+		}
+
+		if (chunks.empty()) {
+			hint = 0;
+			return;
+		}
+
+		offsets.front() = 0;
+		if (c > 0)
+			--c;
+		offsets[c] = c > 0 ? offsets[c - 1] + chunks[c - 1].size() : 0;
+		UpdateOffsets(c);
+		hint = c;
+	}
+};
+
+#endif
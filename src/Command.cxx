@@ -102,6 +102,10 @@ static constexpr command_definition_t cmds[] = {
 	  N_("Delete song from queue") },
 	{ "shuffle",
 	  N_("Shuffle queue") },
+	{ "sort-queue",
+	  N_("Sort queue") },
+	{ "dedupe-queue",
+	  N_("Remove duplicate songs from queue") },
 	{ "clear",
 	  N_("Clear queue") },
 	{ "repeat",
@@ -172,6 +176,10 @@ static constexpr command_definition_t cmds[] = {
 		 * and jumps directly (while the user is typing)
 		 * to the entry which begins with this string */
 	  N_("Jump to") },
+	{ "fuzzy-find",
+	  N_("Fuzzy find") },
+	{ "filter",
+	  N_("Show only the items matching a pattern") },
 
 
 	/* extra screens */
@@ -189,13 +197,15 @@ static constexpr command_definition_t cmds[] = {
 	{ "view",
 	  N_("View the selected and the currently playing song") },
 #endif
-#ifdef ENABLE_LYRICS_SCREEN
-	{ "screen-lyrics",
-	  N_("Lyrics screen") },
+#if defined(ENABLE_SEARCH_SCREEN) || defined(ENABLE_LYRICS_SCREEN)
 	{ "lyrics-interrupt",
 	  /* translators: interrupt the current background action,
 	     e.g. stop loading lyrics from the internet */
 	  N_("Interrupt action") },
+#endif
+#ifdef ENABLE_LYRICS_SCREEN
+	{ "screen-lyrics",
+	  N_("Lyrics screen") },
 	{ "lyrics-update",
 	  N_("Update Lyrics") },
 	/* this command may move out of #ifdef ENABLE_LYRICS_SCREEN
@@ -209,6 +219,11 @@ static constexpr command_definition_t cmds[] = {
 	  N_("Outputs screen") },
 #endif
 
+#ifdef ENABLE_PERF_SCREEN
+	{ "screen-perf",
+	  N_("Performance screen") },
+#endif
+
 #ifdef ENABLE_CHAT_SCREEN
 	{ "screen-chat",
 	  N_("Chat screen") },
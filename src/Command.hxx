@@ -69,6 +69,8 @@ enum class Command : unsigned {
 	SELECT_ALL,
 	DELETE,
 	SHUFFLE,
+	SORT_QUEUE,
+	DEDUPE_QUEUE,
 	CLEAR,
 	REPEAT,
 	RANDOM,
@@ -102,6 +104,8 @@ enum class Command : unsigned {
 	LIST_RFIND,
 	LIST_RFIND_NEXT,
 	LIST_JUMP,
+	LIST_FUZZY_FIND,
+	LIST_FILTER,
 
 	/* extra screens */
 #ifdef ENABLE_LIBRARY_PAGE
@@ -114,15 +118,20 @@ enum class Command : unsigned {
 #ifdef ENABLE_SONG_SCREEN
 	SCREEN_SONG,
 #endif
+#if defined(ENABLE_SEARCH_SCREEN) || defined(ENABLE_LYRICS_SCREEN)
+	INTERRUPT,
+#endif
 #ifdef ENABLE_LYRICS_SCREEN
 	SCREEN_LYRICS,
-	INTERRUPT,
 	LYRICS_UPDATE,
 	EDIT,
 #endif
 #ifdef ENABLE_OUTPUTS_SCREEN
 	SCREEN_OUTPUTS,
 #endif
+#ifdef ENABLE_PERF_SCREEN
+	SCREEN_PERF,
+#endif
 #ifdef ENABLE_CHAT_SCREEN
 	SCREEN_CHAT,
 #endif
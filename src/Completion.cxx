@@ -18,31 +18,31 @@
  */
 
 #include "Completion.hxx"
+#include "PathTrie.hxx"
 
-#include <assert.h>
-
-static bool
-StartsWith(const std::string &haystack, const std::string &needle) noexcept
-{
-	return haystack.length() >= needle.length() &&
-		std::equal(needle.begin(), needle.end(), haystack.begin());
-}
+#include <algorithm>
 
 Completion::Result
 Completion::Complete(const std::string &prefix) const noexcept
 {
-	auto lower = list.lower_bound(prefix);
-	if (lower == list.end() || !StartsWith(*lower, prefix))
-		return {std::string(), {lower, lower}};
-
-	auto upper = list.upper_bound(prefix);
-	while (upper != list.end() && StartsWith(*upper, prefix))
-		++upper;
-
-	assert(upper != lower);
-
-	auto m = std::mismatch(lower->begin(), lower->end(),
-			       std::prev(upper)->begin()).first;
-
-	return {{lower->begin(), m}, {lower, upper}};
+	Result result;
+	list.FindPrefix(prefix, result.range);
+	if (result.range.empty())
+		return result;
+
+	/* the longest common prefix of all candidates; since they
+	   are sorted, it is enough to compare the first and the last
+	   one */
+	const auto &first = result.range.front();
+	const auto &last = result.range.back();
+	auto m = std::mismatch(first.begin(), first.end(), last.begin()).first;
+	result.new_prefix.assign(first.begin(), m);
+
+	/* don't offer the prefix itself (e.g. "dir/" after its
+	   contents have been loaded); being the shortest match, it
+	   can only be the first candidate */
+	if (result.range.front() == prefix)
+		result.range.erase(result.range.begin());
+
+	return result;
 }
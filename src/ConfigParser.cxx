@@ -77,6 +77,7 @@
 #define CONF_HIDE_CURSOR "hide-cursor"
 #define CONF_SEEK_TIME "seek-time"
 #define CONF_LIBRARY_PAGE_TAGS "library-page-tags"
+#define CONF_NATURAL_SORT "natural-sort"
 #define CONF_SCREEN_LIST "screen-list"
 #define CONF_TIMEDISPLAY_TYPE "timedisplay-type"
 #define CONF_HOST "host"
@@ -548,7 +549,9 @@ parse_line(char *line)
 #ifdef ENABLE_LIBRARY_PAGE
 		options.library_page_tags = ParseTagList(value);
 #endif
-	} else if (!strcasecmp(CONF_SCREEN_LIST, name)) {
+	} else if (!strcasecmp(CONF_NATURAL_SORT, name))
+		options.natural_sort = str2bool(value);
+	else if (!strcasecmp(CONF_SCREEN_LIST, name)) {
 		options.screen_list = check_screen_list(value);
 	} else if (!strcasecmp(CONF_HOST, name))
 		options.host = GetStringValue(value);
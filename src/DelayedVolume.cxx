@@ -0,0 +1,96 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "DelayedVolume.hxx"
+#include "mpdclient.hxx"
+
+#include <algorithm>
+#include <utility>
+
+/**
+ * Commit after the user hasn't changed the volume for this
+ * duration.
+ */
+static constexpr std::chrono::steady_clock::duration QUIET_PERIOD =
+	std::chrono::milliseconds(150);
+
+/**
+ * While the user keeps changing the volume, commit at least this
+ * often, so the change can be heard.
+ */
+static constexpr std::chrono::steady_clock::duration MAX_DELAY =
+	std::chrono::milliseconds(500);
+
+void
+DelayedVolume::Commit() noexcept
+{
+	if (target < 0)
+		return;
+
+	const int value = std::exchange(target, -1);
+
+	if (c.RunVolume(value))
+		c.volume = value;
+}
+
+void
+DelayedVolume::Cancel() noexcept
+{
+	commit_timer.cancel();
+}
+
+void
+DelayedVolume::OnTimer(const boost::system::error_code &error) noexcept
+{
+	if (error)
+		return;
+
+	Commit();
+}
+
+void
+DelayedVolume::ScheduleTimer() noexcept
+{
+	const auto now = std::chrono::steady_clock::now();
+	if (!IsPending())
+		pending_since = now;
+
+	boost::system::error_code error;
+	commit_timer.expires_at(std::min(now + QUIET_PERIOD,
+					 pending_since + MAX_DELAY),
+				error);
+	commit_timer.async_wait(std::bind(&DelayedVolume::OnTimer,
+					  this, std::placeholders::_1));
+}
+
+bool
+DelayedVolume::Change(int delta) noexcept
+{
+	const int current = IsPending() ? target : c.volume;
+	if (current < 0)
+		return false;
+
+	const int new_volume = std::min(std::max(current + delta, 0), 100);
+	if (new_volume == current)
+		return true;
+
+	ScheduleTimer();
+	target = new_volume;
+	return true;
+}
@@ -0,0 +1,87 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_DELAYED_VOLUME_HXX
+#define NCMPC_DELAYED_VOLUME_HXX
+
+#include "AsioServiceFwd.hxx"
+
+#include <boost/asio/steady_timer.hpp>
+
+struct mpdclient;
+
+/**
+ * Helper class which handles user volume commands; it accumulates
+ * the new volume locally and sends only one "setvol" command to MPD
+ * after the user has stopped pressing the key (or periodically
+ * while the key is held down).
+ */
+class DelayedVolume {
+	struct mpdclient &c;
+
+	/**
+	 * The volume to be sent to MPD, or -1 if there is none.
+	 */
+	int target = -1;
+
+	/**
+	 * When was #target set after the last commit?
+	 */
+	std::chrono::steady_clock::time_point pending_since;
+
+	boost::asio::steady_timer commit_timer;
+
+public:
+	DelayedVolume(boost::asio::io_service &io_service,
+		      struct mpdclient &_c) noexcept
+		:c(_c), commit_timer(io_service) {}
+
+	~DelayedVolume() noexcept {
+		Cancel();
+	}
+
+	bool IsPending() const noexcept {
+		return target >= 0;
+	}
+
+	/**
+	 * Returns the volume which will be sent to MPD.  Only valid
+	 * if IsPending() returns true.
+	 */
+	int GetVolume() const noexcept {
+		return target;
+	}
+
+	/**
+	 * Change the volume relative to the current (or pending)
+	 * one.
+	 *
+	 * @return false if the volume is not known
+	 */
+	bool Change(int delta) noexcept;
+
+	void Commit() noexcept;
+	void Cancel() noexcept;
+
+private:
+	void OnTimer(const boost::system::error_code &error) noexcept;
+	void ScheduleTimer() noexcept;
+};
+
+#endif
@@ -32,29 +32,100 @@
 #include "screen_client.hxx"
 #include "Command.hxx"
 #include "Options.hxx"
+#include "LruCache.hxx"
 #include "util/UriUtil.hxx"
 
 #include <mpd/client.h>
 
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <string>
 
+#include <assert.h>
 #include <stdlib.h>
 #include <string.h>
 
-class FileBrowserPage final : public FileListPage {
+/**
+ * The maximum number of directory listings in the cache.
+ */
+static constexpr size_t DIRECTORY_CACHE_SIZE = 32;
+
+/**
+ * If the cursor rests on a directory for this duration, its listing
+ * gets prefetched.
+ */
+static constexpr std::chrono::steady_clock::duration PREFETCH_DELAY =
+	std::chrono::milliseconds(300);
+
+class FileBrowserPage final : public FileListPage, MpdEntityHandler {
 	std::string current_path;
 
+	/**
+	 * Recently visited and prefetched directory listings (sorted,
+	 * but without highlights).  It is cleared when the database or
+	 * the stored playlists change.
+	 */
+	LruCache<std::string, std::unique_ptr<FileList>> cache{DIRECTORY_CACHE_SIZE};
+
+	boost::asio::steady_timer prefetch_timer;
+
+	/**
+	 * The client passed to the last OnCommand() call; used by
+	 * #prefetch_timer.
+	 */
+	struct mpdclient *prefetch_client = nullptr;
+
+	/**
+	 * The directory which shall be prefetched by #prefetch_timer.
+	 */
+	std::string prefetch_path;
+
+	/**
+	 * The listing which is currently being prefetched (received
+	 * in portions from the main loop), and its path.  nullptr if
+	 * no prefetch is in progress.
+	 */
+	std::unique_ptr<FileList> prefetch_list;
+	std::string prefetching_path;
+
 public:
 	FileBrowserPage(ScreenManager &_screen, WINDOW *_w,
 			Size size)
 		:FileListPage(_screen, _w, size,
-			      options.list_format.c_str()) {}
+			      options.list_format.c_str()),
+		 prefetch_timer(_screen.get_io_service()) {}
+
+	~FileBrowserPage() noexcept override {
+		CancelPrefetch();
+	}
 
 	bool GotoSong(struct mpdclient &c, const struct mpd_song &song);
 
 private:
 	void Reload(struct mpdclient &c);
 
+	/**
+	 * Move the current listing to the cache (unless it is
+	 * outdated) and clear it.
+	 */
+	void StashFileList() noexcept;
+
+	/**
+	 * If the cursor is on a directory which is not in the cache,
+	 * schedule prefetching it.
+	 */
+	void SchedulePrefetch(struct mpdclient &c) noexcept;
+
+	void OnPrefetchTimer(const boost::system::error_code &error) noexcept;
+
+	/**
+	 * Cancel a scheduled or running prefetch.
+	 */
+	void CancelPrefetch() noexcept;
+
 	/**
 	 * Change to the specified absolute directory.
 	 */
@@ -75,56 +146,206 @@ private:
 	void HandleSave(struct mpdclient &c);
 	void HandleDelete(struct mpdclient &c);
 
+	/* virtual methods from class MpdEntityHandler */
+	void OnEntity(struct mpd_entity &entity) noexcept override;
+	void OnEntityPortion() noexcept override {}
+	void OnEntityEnd(bool success) noexcept override;
+
 public:
 	/* virtual methods from class Page */
+	void OnClose() noexcept override;
 	void Update(struct mpdclient &c, unsigned events) noexcept override;
 	bool OnCommand(struct mpdclient &c, Command cmd) override;
 	const char *GetTitle(char *s, size_t size) const noexcept override;
 };
 
-static void
+static bool
 screen_file_load_list(struct mpdclient *c, const char *current_path,
 		      FileList *filelist)
 {
 	auto *connection = c->GetConnection();
 	if (connection == nullptr)
-		return;
+		return false;
 
 	mpd_send_list_meta(connection, current_path);
 	filelist->Receive(*connection);
 
-	if (c->FinishCommand())
-		filelist->Sort();
+	if (!c->FinishCommand())
+		return false;
+
+	filelist->Sort();
+	return true;
+}
+
+/**
+ * Load the (sorted) listing of the given directory.
+ *
+ * @return the new list or nullptr on error
+ */
+static std::unique_ptr<FileList>
+LoadDirectory(struct mpdclient &c, const std::string &path) noexcept
+{
+	std::unique_ptr<FileList> filelist(new FileList());
+	if (!path.empty())
+		/* add a dummy entry for ./.. */
+		filelist->emplace_back(nullptr);
+
+	if (!screen_file_load_list(&c, path.c_str(), filelist.get()))
+		return nullptr;
+
+	return filelist;
 }
 
 void
 FileBrowserPage::Reload(struct mpdclient &c)
 {
-	delete filelist;
+	if (prefetch_list != nullptr && prefetching_path == current_path)
+		/* this directory is being prefetched: receive the
+		   rest of it, which puts it into the cache */
+		c.GetConnection();
+
+	std::unique_ptr<FileList> new_filelist;
+	if (filelist != nullptr || !cache.Take(current_path, new_filelist)) {
+		new_filelist = LoadDirectory(c, current_path);
+		if (new_filelist == nullptr) {
+			/* show an empty list (or just "..") */
+			new_filelist.reset(new FileList());
+			if (!current_path.empty())
+				new_filelist->emplace_back(nullptr);
+		}
+	}
+
+	ReplaceFileList(new_filelist.release());
+
+	if (SyncHighlights(c.playlist))
+		SetDirty();
+}
+
+void
+FileBrowserPage::StashFileList() noexcept
+{
+	if (filelist != nullptr &&
+	    !HasPendingEvents(MPD_IDLE_DATABASE | MPD_IDLE_STORED_PLAYLIST))
+		cache.Put(std::string(current_path),
+			  std::unique_ptr<FileList>(filelist));
+	else
+		delete filelist;
 
-	filelist = new FileList();
-	if (!current_path.empty())
+	filelist = nullptr;
+	InvalidateCaches();
+}
+
+void
+FileBrowserPage::SchedulePrefetch(struct mpdclient &c) noexcept
+{
+	const auto *entity = GetSelectedEntity();
+	if (entity == nullptr ||
+	    mpd_entity_get_type(entity) != MPD_ENTITY_TYPE_DIRECTORY)
+		return;
+
+	const char *path =
+		mpd_directory_get_path(mpd_entity_get_directory(entity));
+	if (path == prefetch_path || cache.Contains(path))
+		return;
+
+	prefetch_client = &c;
+	prefetch_path = path;
+
+	boost::system::error_code error;
+	prefetch_timer.expires_from_now(PREFETCH_DELAY, error);
+	prefetch_timer.async_wait(std::bind(&FileBrowserPage::OnPrefetchTimer,
+					    this, std::placeholders::_1));
+}
+
+void
+FileBrowserPage::OnPrefetchTimer(const boost::system::error_code &error) noexcept
+{
+	if (error || prefetch_path.empty())
+		return;
+
+	auto path = std::move(prefetch_path);
+	prefetch_path.clear();
+
+	auto &c = *prefetch_client;
+	if (!c.IsConnected() || cache.Contains(path) ||
+	    prefetch_list != nullptr ||
+	    /* don't block on another response, e.g. a search */
+	    c.IsReceivingEntities())
+		return;
+
+	auto *connection = c.GetConnection();
+	if (connection == nullptr)
+		return;
+
+	if (!mpd_send_list_meta(connection, path.c_str())) {
+		c.HandleError();
+		return;
+	}
+
+	prefetch_list.reset(new FileList());
+	if (!path.empty())
 		/* add a dummy entry for ./.. */
-		filelist->emplace_back(nullptr);
+		prefetch_list->emplace_back(nullptr);
 
-	screen_file_load_list(&c, current_path.c_str(), filelist);
+	prefetching_path = std::move(path);
 
-	lw.SetLength(filelist->size());
+	/* receive the listing from the main loop, so a slow
+	   connection doesn't block user input */
+	c.ReceiveEntitiesAsync(*this);
+}
 
-	SetDirty();
+void
+FileBrowserPage::CancelPrefetch() noexcept
+{
+	prefetch_timer.cancel();
+	prefetch_path.clear();
+
+	if (prefetch_list != nullptr) {
+		prefetch_client->CancelReceiveEntities(*this);
+		prefetch_list.reset();
+		prefetching_path.clear();
+	}
+}
+
+void
+FileBrowserPage::OnEntity(struct mpd_entity &entity) noexcept
+{
+	assert(prefetch_list != nullptr);
+
+	prefetch_list->emplace_back(&entity);
+}
+
+void
+FileBrowserPage::OnEntityEnd(bool success) noexcept
+{
+	assert(prefetch_list != nullptr);
+
+	auto list = std::move(prefetch_list);
+	auto path = std::move(prefetching_path);
+	prefetching_path.clear();
+
+	if (success) {
+		list->Sort();
+		cache.Put(std::move(path), std::move(list));
+	}
 }
 
 bool
 FileBrowserPage::ChangeDirectory(struct mpdclient &c, std::string &&new_path)
 {
+	/* this is a different directory; don't merge with the old
+	   list, but keep it for going back */
+	StashFileList();
+	ClearFilter();
+
 	current_path = std::move(new_path);
 
 	Reload(c);
 
-	screen_browser_sync_highlights(filelist, &c.playlist);
-
 	lw.Reset();
 
+	SchedulePrefetch(c);
+
 	return filelist != nullptr;
 }
 
@@ -156,8 +377,10 @@ FileBrowserPage::ChangeToParent(struct mpdclient &c)
 bool
 FileBrowserPage::ChangeToEntry(struct mpdclient &c, const FileListEntry &entry)
 {
-	if (entry.entity == nullptr)
+	if (entry.IsParent())
 		return ChangeToParent(c);
+	else if (entry.entity == nullptr)
+		return false;
 	else if (mpd_entity_get_type(entry.entity) == MPD_ENTITY_TYPE_DIRECTORY)
 		return ChangeDirectory(c, mpd_directory_get_path(mpd_entity_get_directory(entry.entity)));
 	else
@@ -208,7 +431,7 @@ FileBrowserPage::HandleSave(struct mpdclient &c)
 		return;
 
 	for (const unsigned i : range) {
-		auto &entry = (*filelist)[i];
+		auto &entry = *GetIndex(i);
 		if (entry.entity) {
 			struct mpd_entity *entity = entry.entity;
 			if (mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_PLAYLIST) {
@@ -235,7 +458,7 @@ FileBrowserPage::HandleDelete(struct mpdclient &c)
 
 	const auto range = lw.GetRange();
 	for (const unsigned i : range) {
-		auto &entry = (*filelist)[i];
+		auto &entry = *GetIndex(i);
 		if (entry.entity == nullptr)
 			continue;
 
@@ -302,22 +525,35 @@ FileBrowserPage::GetTitle(char *str, size_t size) const noexcept
 	return str;
 }
 
+void
+FileBrowserPage::OnClose() noexcept
+{
+	/* a prefetch which is already running may finish; it will
+	   be useful when this page is opened again */
+	prefetch_timer.cancel();
+	prefetch_path.clear();
+}
+
 void
 FileBrowserPage::Update(struct mpdclient &c, unsigned events) noexcept
 {
+	if (events & (MPD_IDLE_DATABASE | MPD_IDLE_STORED_PLAYLIST)) {
+		/* all cached listings may be outdated now */
+		cache.Clear();
+		CancelPrefetch();
+	}
+
+	if (c.IsUpdatingDatabase() && (events & MPD_IDLE_UPDATE) == 0)
+		/* a database update is still running: reload only
+		   once after it has finished, not after each step */
+		PostponeEvents(events, MPD_IDLE_DATABASE);
+
 	if (events & (MPD_IDLE_DATABASE | MPD_IDLE_STORED_PLAYLIST)) {
 		/* the db has changed -> update the filelist */
 		Reload(c);
 	}
-
-	if (events & (MPD_IDLE_DATABASE | MPD_IDLE_STORED_PLAYLIST
-#ifndef NCMPC_MINI
-		      | MPD_IDLE_QUEUE
-#endif
-		      )) {
-		screen_browser_sync_highlights(filelist, &c.playlist);
+	else if (events & MPD_IDLE_QUEUE && SyncHighlights(c.playlist))
 		SetDirty();
-	}
 }
 
 bool
@@ -345,15 +581,17 @@ FileBrowserPage::OnCommand(struct mpdclient &c, Command cmd)
 
 	case Command::SCREEN_UPDATE:
 		Reload(c);
-		screen_browser_sync_highlights(filelist, &c.playlist);
 		return false;
 
 	default:
 		break;
 	}
 
-	if (FileListPage::OnCommand(c, cmd))
+	if (FileListPage::OnCommand(c, cmd)) {
+		/* the cursor may have moved to a directory */
+		SchedulePrefetch(c);
 		return true;
+	}
 
 	if (!c.IsConnected())
 		return false;
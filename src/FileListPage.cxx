@@ -32,14 +32,19 @@
 #include "strfsong.hxx"
 #include "mpdclient.hxx"
 #include "filelist.hxx"
+#include "ListDiff.hxx"
 #include "Styles.hxx"
 #include "paint.hxx"
 #include "SongRowPaint.hxx"
 #include "time_format.hxx"
+#include "Match.hxx"
 #include "util/UriUtil.hxx"
 
 #include <mpd/client.h>
 
+#include <string>
+#include <utility>
+
 #include <string.h>
 
 #define BUFSIZE 1024
@@ -53,32 +58,180 @@ FileListPage::~FileListPage() noexcept
 	delete filelist;
 }
 
+void
+FileListPage::ReplaceFileList(FileList *new_filelist) noexcept
+{
+	assert(new_filelist != nullptr);
+
+	InvalidateCaches();
+
+	FileList *old_filelist = std::exchange(filelist, new_filelist);
+	if (list_filter.IsActive()) {
+		/* the differences refer to positions, not to
+		   (filtered) rows */
+		delete old_filelist;
+		UpdateLength();
+		SetDirty();
+		return;
+	}
+
+	if (old_filelist == nullptr || old_filelist->empty()) {
+		delete old_filelist;
+		lw.SetLength(filelist->size());
+		SetDirty();
+		return;
+	}
+
+	const auto diff = DiffFileLists(*old_filelist, *filelist);
+	delete old_filelist;
+
+	/* repaint even if the diff is empty: it compares only the
+	   paths, but the tags of the songs may have changed */
+	ApplyListDiff(lw, diff, filelist->size());
+	SetDirty();
+}
+
 #ifndef NCMPC_MINI
 
-/* sync highlight flags with playlist */
-void
-screen_browser_sync_highlights(FileList *fl, const MpdQueue *playlist)
+/**
+ * Set or clear the highlight flag of the given song entry.
+ *
+ * @return true if the flag has changed
+ */
+static bool
+SetHighlight(FileListEntry &entry, bool highlight) noexcept
 {
-	for (unsigned i = 0; i < fl->size(); ++i) {
-		auto &entry = (*fl)[i];
-		const auto *entity = entry.entity;
+	const unsigned old_flags = entry.flags;
+	if (highlight)
+		entry.flags |= HIGHLIGHT;
+	else
+		entry.flags &= ~HIGHLIGHT;
+	return entry.flags != old_flags;
+}
 
-		if (entity != nullptr && mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_SONG) {
-			const auto *song = mpd_entity_get_song(entity);
+bool
+FileListPage::SyncHighlights(const MpdQueue &queue) noexcept
+{
+	if (filelist == nullptr)
+		return false;
 
-			if (playlist->ContainsUri(mpd_song_get_uri(song)))
-				entry.flags |= HIGHLIGHT;
-			else
-				entry.flags &= ~HIGHLIGHT;
+	bool modified = false;
+
+	const auto visit = [this, &queue, &modified](const std::string &uri){
+		const bool highlight = queue.ContainsUri(uri.c_str());
+		const auto range = uri_index.equal_range(uri.c_str());
+		for (auto i = range.first; i != range.second; ++i)
+			modified |= SetHighlight((*filelist)[i->second],
+						 highlight);
+	};
+
+	if (!uri_index_valid ||
+	    !queue.VisitUriChanges(highlight_serial, visit)) {
+		/* check all songs and (re)build the index */
+		uri_index.clear();
+
+		for (unsigned i = 0; i < filelist->size(); ++i) {
+			auto &entry = (*filelist)[i];
+			const auto *entity = entry.entity;
+			if (entity == nullptr ||
+			    mpd_entity_get_type(entity) != MPD_ENTITY_TYPE_SONG)
+				continue;
+
+			const char *uri =
+				mpd_song_get_uri(mpd_entity_get_song(entity));
+			uri_index.emplace(uri, i);
+			modified |= SetHighlight(entry,
+						 queue.ContainsUri(uri));
 		}
+
+		uri_index_valid = true;
 	}
+
+	highlight_serial = queue.GetUriSerial();
+	return modified;
 }
 
 #endif
 
+void
+FileListPage::UpdateLength() noexcept
+{
+	if (filelist == nullptr) {
+		list_filter.Clear();
+		lw.SetLength(0);
+		return;
+	}
+
+	RefreshFilter();
+	lw.SetLength(list_filter.GetRowCount(filelist->size()));
+}
+
+void
+FileListPage::RefreshFilter() noexcept
+{
+	assert(filelist != nullptr);
+
+	if (!list_filter.IsActive())
+		return;
+
+	const auto *expression =
+		GetMatchExpression(list_filter.GetPattern().c_str(), false);
+	assert(expression != nullptr);
+
+	list_filter.Refresh(filelist->size(),
+			    [this, expression](unsigned position){
+				    return MatchFilter(*expression, position);
+			    });
+}
+
+bool
+FileListPage::MatchFilter(const MatchExpression &expression,
+			  unsigned position) const noexcept
+{
+	if ((*filelist)[position].IsParent())
+		/* always show ".." */
+		return true;
+
+	char buffer[BUFSIZE];
+	return expression(GetEntryText(buffer, sizeof(buffer), position));
+}
+
+void
+FileListPage::EditFilter() noexcept
+{
+	std::string pattern = list_filter.GetPattern();
+	if (!screen_read_filter(screen, pattern))
+		return;
+
+	if (pattern.empty()) {
+		list_filter.Clear();
+	} else {
+		const auto *expression =
+			GetMatchExpression(pattern.c_str(), false);
+		assert(expression != nullptr);
+
+		list_filter.Set(std::move(pattern), filelist->size(),
+				[this, expression](unsigned position){
+					return MatchFilter(*expression,
+							   position);
+				});
+	}
+
+	lw.SetLength(list_filter.GetRowCount(filelist->size()));
+	lw.SetCursor(0);
+	SetDirty();
+}
+
 const char *
 FileListPage::GetListItemText(char *buffer, size_t size,
 			      unsigned idx) const noexcept
+{
+	return GetEntryText(buffer, size, list_filter.ToPosition(idx));
+}
+
+const char *
+FileListPage::GetEntryText(char *buffer, size_t size,
+			   unsigned idx) const noexcept
 {
 	assert(filelist != nullptr);
 	assert(idx < filelist->size());
@@ -86,6 +239,9 @@ FileListPage::GetListItemText(char *buffer, size_t size,
 	const auto &entry = (*filelist)[idx];
 	const auto *entity = entry.entity;
 
+	if (entry.IsPlaceholder())
+		return "";
+
 	if( entity == nullptr )
 		return "..";
 
@@ -107,6 +263,18 @@ FileListPage::GetListItemText(char *buffer, size_t size,
 	return "Error: Unknown entry!";
 }
 
+const std::vector<std::string> *
+FileListPage::GetCachedListItemTexts(unsigned length,
+				     bool folded) const noexcept
+{
+	if (filelist == nullptr || length != filelist->size() ||
+	    /* the cache is indexed by position, not by row */
+	    list_filter.IsActive())
+		return nullptr;
+
+	return &text_cache.Get(*this, length, folded);
+}
+
 static bool
 load_playlist(struct mpdclient *c, const struct mpd_playlist *playlist)
 {
@@ -172,13 +340,11 @@ FileListPage::GetSelectedEntry() const
 {
 	const auto range = lw.GetRange();
 
-	if (filelist == nullptr ||
-	    range.empty() ||
-	    range.end_index > range.start_index + 1 ||
-	    range.start_index >= filelist->size())
+	if (range.empty() ||
+	    range.end_index > range.start_index + 1)
 		return nullptr;
 
-	return &(*filelist)[range.start_index];
+	return GetIndex(range.start_index);
 }
 
 const struct mpd_entity *
@@ -194,8 +360,11 @@ FileListPage::GetSelectedEntity() const
 const struct mpd_song *
 FileListPage::GetSelectedSong() const
 {
-	const auto *entity = GetSelectedEntity();
+	const auto *entry = GetSelectedEntry();
+	if (entry == nullptr || entry->IsPlaceholder())
+		return nullptr;
 
+	const auto *entity = entry->entity;
 	return entity != nullptr &&
 		mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_SONG
 		? mpd_entity_get_song(entity)
@@ -205,21 +374,23 @@ FileListPage::GetSelectedSong() const
 FileListEntry *
 FileListPage::GetIndex(unsigned i) const
 {
-	if (filelist == nullptr || i >= filelist->size())
+	if (filelist == nullptr ||
+	    i >= list_filter.GetRowCount(filelist->size()))
 		return nullptr;
 
-	return &(*filelist)[i];
+	return &(*filelist)[list_filter.ToPosition(i)];
 }
 
 bool
 FileListPage::HandleEnter(struct mpdclient &c)
 {
 	auto *entry = GetSelectedEntry();
-	if (entry == nullptr)
+	if (entry == nullptr || entry->IsPlaceholder())
 		return false;
 
 	auto *entity = entry->entity;
 	if (entity == nullptr)
+		/* ".." */
 		return false;
 
 	if (mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_PLAYLIST)
@@ -325,8 +496,10 @@ FileListPage::HandleSelectAll(struct mpdclient &c)
 	if (filelist == nullptr)
 		return;
 
-	for (unsigned i = 0; i < filelist->size(); ++i) {
-		auto &entry = (*filelist)[i];
+	/* only the visible entries */
+	const unsigned n = list_filter.GetRowCount(filelist->size());
+	for (unsigned i = 0; i < n; ++i) {
+		auto &entry = *GetIndex(i);
 
 		if (entry.entity != nullptr)
 			browser_select_entry(&c, &entry, false);
@@ -386,6 +559,16 @@ FileListPage::OnCommand(struct mpdclient &c, Command cmd)
 		screen_jump(screen, lw, *this, *this);
 		SetDirty();
 		return true;
+	case Command::LIST_FUZZY_FIND:
+		screen_fuzzy_find(lw, *this, *this);
+		SetDirty();
+		return true;
+	case Command::LIST_FILTER:
+		if (CanFilter())
+			EditFilter();
+		else
+			screen_status_message(_("This list cannot be filtered"));
+		return true;
 
 #ifdef ENABLE_SONG_SCREEN
 	case Command::SCREEN_SONG:
@@ -482,10 +665,15 @@ FileListPage::PaintListItem(WINDOW *w, unsigned i,
 			    bool selected) const noexcept
 {
 	assert(filelist != nullptr);
-	assert(i < filelist->size());
 
-	const auto &entry = (*filelist)[i];
+	const auto &entry = *GetIndex(i);
 	const struct mpd_entity *entity = entry.entity;
+	if (entry.IsPlaceholder()) {
+		/* not loaded yet */
+		row_paint_text(w, width, Style::LIST, selected, "");
+		return;
+	}
+
 	if (entity == nullptr) {
 		screen_browser_paint_directory(w, width, selected, "..");
 		return;
@@ -550,10 +738,10 @@ FileListPage::PaintStatusBarOverride(const Window &window) const noexcept
 
 	assert(filelist != nullptr);
 	for (const unsigned i : lw.GetRange()) {
-		assert(i < filelist->size());
-		const auto &entry = (*filelist)[i];
+		const auto &entry = *GetIndex(i);
 
-		if (mpd_entity_get_type(entry.entity) == MPD_ENTITY_TYPE_SONG)
+		if (entry.entity != nullptr &&
+		    mpd_entity_get_type(entry.entity) == MPD_ENTITY_TYPE_SONG)
 			duration += mpd_song_get_duration(mpd_entity_get_song(entry.entity));
 	}
 
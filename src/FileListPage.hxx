@@ -24,6 +24,14 @@
 #include "ListPage.hxx"
 #include "ListRenderer.hxx"
 #include "ListText.hxx"
+#include "ListTextCache.hxx"
+#include "ListFilter.hxx"
+
+#ifndef NCMPC_MINI
+#include "UriSet.hxx"
+
+#include <unordered_map>
+#endif
 
 #include <curses.h>
 
@@ -31,6 +39,7 @@ struct mpdclient;
 struct MpdQueue;
 class ScreenManager;
 class FileList;
+class MatchExpression;
 struct FileListEntry;
 
 class FileListPage : public ListPage, ListRenderer, ListText {
@@ -40,6 +49,36 @@ protected:
 	FileList *filelist = nullptr;
 	const char *const song_format;
 
+private:
+	/**
+	 * The texts of all #filelist entries, for searching.
+	 */
+	mutable ListTextCache text_cache;
+
+	/**
+	 * Shows only the entries matching a pattern.
+	 */
+	ListFilter list_filter;
+
+#ifndef NCMPC_MINI
+	/**
+	 * Maps song URIs to their positions in #filelist.  It allows
+	 * SyncHighlights() to visit only the entries affected by a
+	 * queue change.  It is only valid if #uri_index_valid is
+	 * set.
+	 */
+	std::unordered_multimap<const char *, unsigned,
+				CStringHash, CStringEqual> uri_index;
+
+	/**
+	 * The MpdQueue::GetUriSerial() value at the last
+	 * SyncHighlights() call.
+	 */
+	unsigned long highlight_serial;
+
+	bool uri_index_valid = false;
+#endif
+
 public:
 	FileListPage(ScreenManager &_screen, WINDOW *_w,
 		     Size size,
@@ -60,9 +99,92 @@ protected:
 	gcc_pure
 	const struct mpd_song *GetSelectedSong() const;
 
+	/**
+	 * Returns the entry shown in the given row.
+	 */
 	FileListEntry *GetIndex(unsigned i) const;
 
+	/**
+	 * Replace #filelist with a new one.  If there was an old
+	 * list, only the differences are applied to the cursor: it
+	 * stays on the same item, and the page is repainted only if
+	 * something has changed.
+	 */
+	void ReplaceFileList(FileList *new_filelist) noexcept;
+
+	/**
+	 * Synchronize the highlight flags of #filelist with the
+	 * queue.  After the first call, only the songs whose URIs
+	 * have been added to or removed from the queue are visited.
+	 *
+	 * @return true if at least one flag has changed
+	 */
+#ifndef NCMPC_MINI
+	bool SyncHighlights(const MpdQueue &queue) noexcept;
+#else
+	bool SyncHighlights(const MpdQueue &) noexcept {
+		return false;
+	}
+#endif
+
+	/**
+	 * Must be called after #filelist has been modified or
+	 * replaced without ReplaceFileList().  It discards the URI
+	 * index and the search texts.
+	 */
+	void InvalidateCaches() noexcept {
+		text_cache.Invalidate();
+#ifndef NCMPC_MINI
+		uri_index_valid = false;
+		uri_index.clear();
+#endif
+	}
+
+	/**
+	 * Match the filter against #filelist again (if it is active)
+	 * and update the length of the list window.  Must be called
+	 * after #filelist has been modified or replaced without
+	 * ReplaceFileList().
+	 */
+	void UpdateLength() noexcept;
+
+	/**
+	 * Disable the filter, e.g. before switching to a different
+	 * list.
+	 */
+	void ClearFilter() noexcept {
+		list_filter.Clear();
+	}
+
+	/**
+	 * May the user filter this list?
+	 */
+	virtual bool CanFilter() const noexcept {
+		return true;
+	}
+
 private:
+	/**
+	 * Returns the text of the entry at the given #filelist
+	 * position.
+	 */
+	const char *GetEntryText(char *buffer, size_t size,
+				 unsigned position) const noexcept;
+
+	gcc_pure
+	bool MatchFilter(const MatchExpression &expression,
+			 unsigned position) const noexcept;
+
+	/**
+	 * Match all entries against the filter pattern.
+	 */
+	void RefreshFilter() noexcept;
+
+	/**
+	 * Ask the user for a new filter pattern.
+	 */
+	void EditFilter() noexcept;
+
 	bool HandleEnter(struct mpdclient &c);
 	bool HandleSelect(struct mpdclient &c);
 	bool HandleAdd(struct mpdclient &c);
@@ -81,6 +203,9 @@ private:
 	/* virtual methods from class ListText */
 	const char *GetListItemText(char *buffer, size_t size,
 				    unsigned i) const noexcept override;
+	const std::vector<std::string> *
+	GetCachedListItemTexts(unsigned length,
+			       bool folded) const noexcept override;
 
 public:
 	/* virtual methods from class Page */
@@ -94,22 +219,6 @@ public:
 #endif
 };
 
-#ifndef NCMPC_MINI
-
-void
-screen_browser_sync_highlights(FileList *fl,
-			       const MpdQueue *playlist);
-
-#else
-
-static inline void
-screen_browser_sync_highlights(gcc_unused FileList *fl,
-			       gcc_unused const MpdQueue *playlist)
-{
-}
-
-#endif
-
 void
 screen_browser_paint_directory(WINDOW *w, unsigned width,
 			       bool selected, const char *name);
@@ -0,0 +1,129 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "FoldCase.hxx"
+#include "charset.hxx"
+
+#include <string.h>
+
+/**
+ * The base letters of U+00C0 to U+00FF; a null byte means the
+ * character is not folded.
+ */
+static constexpr char latin1_fold[] =
+	"aaaaaa" "\0" "ceeeeiiii"
+	"dnooooo" "\0" "ouuuuy" "\0\0"
+	"aaaaaa" "\0" "ceeeeiiii"
+	"dnooooo" "\0" "ouuuuy" "\0" "y";
+
+/**
+ * The base letters of U+0100 to U+017F (Latin Extended-A).
+ */
+static constexpr char latin_extended_a_fold[] =
+	"aaaaaaccccccccdd"
+	"ddeeeeeeeeeegggg"
+	"gggghhhhiiiiiiii"
+	"ii" "\0\0" "jjkkklllllll"
+	"lllnnnnnnnnnoooo"
+	"oo" "\0\0" "rrrrrrssssss"
+	"ssttttttuuuuuuuu"
+	"uuuuwwyyyzzzzzzs";
+
+static_assert(sizeof(latin1_fold) == 0x40 + 1, "Wrong table size");
+static_assert(sizeof(latin_extended_a_fold) == 0x80 + 1,
+	      "Wrong table size");
+
+/**
+ * Look up the base letter of a two-byte UTF-8 sequence.
+ *
+ * @return the base letter or 0 if the character is not folded
+ */
+gcc_const
+static char
+FoldTwoByte(unsigned char a, unsigned char b) noexcept
+{
+	if ((b & 0xc0) != 0x80)
+		/* not a continuation byte */
+		return 0;
+
+	const unsigned ch = ((a & 0x1f) << 6) | (b & 0x3f);
+	if (ch >= 0xc0 && ch < 0x100)
+		return latin1_fold[ch - 0xc0];
+	else if (ch >= 0x100 && ch < 0x180)
+		return latin_extended_a_fold[ch - 0x100];
+	else
+		return 0;
+}
+
+std::string
+FoldCase(const char *s) noexcept
+{
+	std::string result;
+	result.reserve(strlen(s));
+
+	const bool utf8 = IsLocaleUtf8();
+
+	while (*s != 0) {
+		const unsigned char ch = *s;
+		if (ch >= 'A' && ch <= 'Z') {
+			result.push_back(ch - 'A' + 'a');
+			++s;
+		} else if (utf8 && ch >= 0xc3 && ch <= 0xc5) {
+			/* the lead bytes of U+00C0 to U+017F */
+			const char base = FoldTwoByte(ch, s[1]);
+			if (base != 0) {
+				result.push_back(base);
+				s += 2;
+			} else
+				result.push_back(*s++);
+		} else
+			result.push_back(*s++);
+	}
+
+	return result;
+}
+
+const char *
+FindFolded(const char *haystack, size_t length,
+	   const std::string &needle) noexcept
+{
+	const size_t n = needle.length();
+	if (n == 0)
+		return haystack;
+
+	if (length < n)
+		return nullptr;
+
+	const char first = needle.front(), last = needle.back();
+
+	/* the last position where the needle may start */
+	const char *const end = haystack + length - n;
+
+	for (const char *p = haystack; p <= end; ++p) {
+		p = (const char *)memchr(p, first, end - p + 1);
+		if (p == nullptr)
+			break;
+
+		if (p[n - 1] == last &&
+		    memcmp(p + 1, needle.data() + 1, n - 1) == 0)
+			return p;
+	}
+
+	return nullptr;
+}
@@ -0,0 +1,56 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_FOLD_CASE_HXX
+#define NCMPC_FOLD_CASE_HXX
+
+#include "util/Compiler.h"
+
+#include <string>
+
+#include <stddef.h>
+
+/**
+ * Convert a string to a form for caseless and accent-insensitive
+ * matching: ASCII letters are converted to lower case, and Latin
+ * letters with diacritics (U+00C0 to U+017F, encoded in UTF-8) are
+ * replaced with their lower case base letter.  All other bytes are
+ * copied.
+ *
+ * The string is in the locale charset; if that is not UTF-8, only
+ * ASCII letters are folded.
+ */
+gcc_pure
+std::string
+FoldCase(const char *s) noexcept;
+
+/**
+ * Find a (folded) needle in a (folded) haystack.  Candidate
+ * positions are located with memchr() on the first byte of the
+ * needle and checked against its last byte before comparing the
+ * rest.
+ *
+ * @return the position of the first match or nullptr
+ */
+gcc_pure
+const char *
+FindFolded(const char *haystack, size_t length,
+	   const std::string &needle) noexcept;
+
+#endif
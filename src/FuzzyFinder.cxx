@@ -0,0 +1,226 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "FuzzyFinder.hxx"
+#include "FoldCase.hxx"
+
+#include <algorithm>
+
+#include <assert.h>
+
+static constexpr int SCORE_MATCH = 16;
+static constexpr int BONUS_CONSECUTIVE = 8;
+static constexpr int BONUS_BOUNDARY = 8;
+static constexpr int PENALTY_GAP = 1;
+
+/**
+ * Map a (folded) character to a bit: one for each letter and digit,
+ * and the remaining 28 bits are shared by all other bytes.
+ */
+gcc_const
+static uint64_t
+CharMask(unsigned char ch) noexcept
+{
+	if (ch >= 'a' && ch <= 'z')
+		return uint64_t(1) << (ch - 'a');
+	else if (ch >= '0' && ch <= '9')
+		return uint64_t(1) << (26 + ch - '0');
+	else
+		return uint64_t(1) << (36 + ch % 28);
+}
+
+gcc_pure
+static uint64_t
+StringMask(const std::string &s) noexcept
+{
+	uint64_t mask = 0;
+	for (const char ch : s)
+		mask |= CharMask(ch);
+	return mask;
+}
+
+gcc_const
+static bool
+IsWordBoundary(char ch) noexcept
+{
+	return ch == ' ' || ch == '-' || ch == '_' || ch == '/' ||
+		ch == '.' || ch == '(' || ch == '[';
+}
+
+/**
+ * Match the pattern as a subsequence of the key and calculate a
+ * score.  Like fzf's "v1" algorithm, this finds the first
+ * occurrence, then shrinks it from the left by scanning backwards
+ * from its end, and scores the resulting window.
+ *
+ * @return false if the pattern does not match
+ */
+static bool
+FuzzyScore(const std::string &key, const std::string &pattern,
+	   int &score_r) noexcept
+{
+	assert(!pattern.empty());
+
+	const size_t n = key.length(), m = pattern.length();
+
+	size_t i = 0, j = 0;
+	for (; i < n && j < m; ++i)
+		if (key[i] == pattern[j])
+			++j;
+
+	if (j < m)
+		return false;
+
+	const size_t end = i;
+
+	size_t start = end;
+	while (j > 0)
+		if (key[--start] == pattern[j - 1])
+			--j;
+
+	int score = 0;
+	bool previous_matched = false;
+	for (i = start; i < end; ++i) {
+		if (j < m && key[i] == pattern[j]) {
+			score += SCORE_MATCH;
+			if (previous_matched)
+				score += BONUS_CONSECUTIVE;
+			if (i == 0 || IsWordBoundary(key[i - 1]))
+				score += BONUS_BOUNDARY;
+
+			previous_matched = true;
+			++j;
+		} else {
+			score -= PENALTY_GAP;
+			previous_matched = false;
+		}
+	}
+
+	score_r = score;
+	return true;
+}
+
+/**
+ * Is #a a better result than #b?
+ */
+gcc_pure
+static bool
+IsBetter(const FuzzyFinder::Result &a, const FuzzyFinder::Result &b) noexcept
+{
+	return a.score > b.score ||
+		(a.score == b.score && a.index < b.index);
+}
+
+/**
+ * Keeps the #max_size best results in a heap whose first element is
+ * the worst one.
+ */
+class TopResults {
+	std::vector<FuzzyFinder::Result> heap;
+	const size_t max_size;
+
+public:
+	explicit TopResults(size_t _max_size) noexcept
+		:max_size(_max_size) {
+		heap.reserve(max_size);
+	}
+
+	void Add(FuzzyFinder::Result r) noexcept {
+		if (heap.size() < max_size) {
+			heap.push_back(r);
+			std::push_heap(heap.begin(), heap.end(), IsBetter);
+		} else if (max_size > 0 && IsBetter(r, heap.front())) {
+			std::pop_heap(heap.begin(), heap.end(), IsBetter);
+			heap.back() = r;
+			std::push_heap(heap.begin(), heap.end(), IsBetter);
+		}
+	}
+
+	/**
+	 * Return the results, the best one first.
+	 */
+	std::vector<FuzzyFinder::Result> Finish() noexcept {
+		std::sort_heap(heap.begin(), heap.end(), IsBetter);
+		return std::move(heap);
+	}
+};
+
+FuzzyFinder::FuzzyFinder(const std::vector<std::string> &_keys) noexcept
+	:keys(_keys)
+{
+	masks.reserve(keys.size());
+	for (const auto &i : keys)
+		masks.push_back(StringMask(i));
+}
+
+std::vector<FuzzyFinder::Result>
+FuzzyFinder::Find(const char *_pattern, size_t max_results) noexcept
+{
+	const std::string pattern = FoldCase(_pattern);
+
+	/* discard the steps for patterns which have been shortened
+	   (backspace) or replaced */
+	while (!steps.empty() &&
+	       pattern.compare(0, steps.back().pattern.length(),
+			       steps.back().pattern) != 0)
+		steps.pop_back();
+
+	TopResults top(max_results);
+
+	if (pattern.empty()) {
+		/* everything matches; keep the list order */
+		for (unsigned i = 0; i < keys.size() && i < max_results; ++i)
+			top.Add({i, 0});
+		return top.Finish();
+	}
+
+	const uint64_t pattern_mask = StringMask(pattern);
+	const auto *previous = steps.empty()
+		? nullptr
+		: &steps.back().matches;
+
+	std::vector<unsigned> matches;
+
+	const auto check = [&](unsigned i){
+		if ((masks[i] & pattern_mask) != pattern_mask)
+			return;
+
+		int score;
+		if (FuzzyScore(keys[i], pattern, score)) {
+			matches.push_back(i);
+			top.Add({i, score});
+		}
+	};
+
+	if (previous != nullptr)
+		/* a longer pattern matches only items which have
+		   matched its prefix */
+		for (const unsigned i : *previous)
+			check(i);
+	else
+		for (unsigned i = 0; i < keys.size(); ++i)
+			check(i);
+
+	if (!steps.empty() && steps.back().pattern == pattern)
+		steps.back().matches = std::move(matches);
+	else
+		steps.push_back({pattern, std::move(matches)});
+
+	return top.Finish();
+}
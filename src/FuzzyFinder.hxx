@@ -0,0 +1,106 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_FUZZY_FINDER_HXX
+#define NCMPC_FUZZY_FINDER_HXX
+
+#include "util/Compiler.h"
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Ranks list items by how well they match a pattern as a
+ * subsequence, like fzf does.  Consecutive matches and matches at
+ * word boundaries score higher; gaps lower the score.
+ *
+ * Like #IncrementalJump, this is meant for a pattern which is typed
+ * one character at a time: the items matching a pattern are kept,
+ * and a longer pattern is matched only against them.
+ */
+class FuzzyFinder {
+	/**
+	 * The texts of all items, converted with FoldCase().
+	 */
+	const std::vector<std::string> &keys;
+
+	/**
+	 * A bit mask of the characters occurring in each item (see
+	 * CharMask()).  An item can only match if its mask contains
+	 * all bits of the pattern's mask; checking this first skips
+	 * most items without looking at their text.
+	 */
+	std::vector<uint64_t> masks;
+
+	struct Step {
+		/**
+		 * The folded pattern.
+		 */
+		std::string pattern;
+
+		/**
+		 * The (ascending) indexes of all items which match
+		 * #pattern.
+		 */
+		std::vector<unsigned> matches;
+	};
+
+	/**
+	 * One element for each pattern which was passed to Find();
+	 * each one is a prefix of the following ones.
+	 */
+	std::vector<Step> steps;
+
+public:
+	struct Result {
+		unsigned index;
+		int score;
+	};
+
+	/**
+	 * @param keys the texts of all items, converted with
+	 * FoldCase() (e.g. by #FoldedListTexts); the vector is not
+	 * copied and must remain valid as long as this object exists
+	 */
+	explicit FuzzyFinder(const std::vector<std::string> &keys) noexcept;
+
+	/**
+	 * Returns the number of items which matched the pattern of
+	 * the last Find() call.
+	 */
+	gcc_pure
+	size_t GetMatchCount() const noexcept {
+		return steps.empty() ? keys.size() : steps.back().matches.size();
+	}
+
+	/**
+	 * Find the items matching the given pattern.
+	 *
+	 * @param max_results the maximum number of results
+	 * @return the best results, the best one first; items with
+	 * the same score are sorted by their position in the list
+	 */
+	std::vector<Result> Find(const char *pattern,
+				 size_t max_results) noexcept;
+};
+
+#endif
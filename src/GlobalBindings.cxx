@@ -93,6 +93,8 @@ static KeyBindings global_key_bindings{{{
 	{'t'},
 	{DEL, 'd'},
 	{'Z'},
+	{'O'},
+	{'D'},
 	{'c'},
 	{'r'},
 	{'z'},
@@ -130,6 +132,8 @@ static KeyBindings global_key_bindings{{{
 	{'?'},
 	{'p'},
 	{'.'},
+	{C('F')},
+	{'|'},
 
 
 	/* extra screens */
@@ -143,9 +147,11 @@ static KeyBindings global_key_bindings{{{
 #ifdef ENABLE_SONG_SCREEN
 	{'i'},
 #endif
+#if defined(ENABLE_SEARCH_SCREEN) || defined(ENABLE_LYRICS_SCREEN)
+	{ESC},
+#endif
 #ifdef ENABLE_LYRICS_SCREEN
 	{'7', F7},
-	{ESC},
 	{'u'},
 	{'e'},
 #endif
@@ -154,6 +160,10 @@ static KeyBindings global_key_bindings{{{
 	{'8', F8},
 #endif
 
+#ifdef ENABLE_PERF_SCREEN
+	{'0'},
+#endif
+
 #ifdef ENABLE_CHAT_SCREEN
 	{'9', F9},
 #endif
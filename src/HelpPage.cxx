@@ -93,6 +93,9 @@ static constexpr HelpRow help_text[] = {
 #ifdef ENABLE_OUTPUTS_SCREEN
 	Command::SCREEN_OUTPUTS,
 #endif
+#ifdef ENABLE_PERF_SCREEN
+	Command::SCREEN_PERF,
+#endif
 #ifdef ENABLE_CHAT_SCREEN
 	Command::SCREEN_CHAT,
 #endif
@@ -127,6 +130,8 @@ static constexpr HelpRow help_text[] = {
 	Command::LIST_FIND_NEXT,
 	Command::LIST_RFIND_NEXT,
 	Command::LIST_JUMP,
+	Command::LIST_FUZZY_FIND,
+	Command::LIST_FILTER,
 	Command::TOGGLE_FIND_WRAP,
 	Command::LOCATE,
 #ifdef ENABLE_SONG_SCREEN
@@ -142,6 +147,8 @@ static constexpr HelpRow help_text[] = {
 	{ Command::PLAY, N_("Play") },
 	Command::DELETE,
 	Command::CLEAR,
+	Command::SORT_QUEUE,
+	Command::DEDUPE_QUEUE,
 	Command::LIST_MOVE_UP,
 	Command::LIST_MOVE_DOWN,
 	Command::ADD,
@@ -174,6 +181,7 @@ static constexpr HelpRow help_text[] = {
 	{ Command::ADD, N_("Append song to queue") },
 	Command::SELECT_ALL,
 	Command::SEARCH_MODE,
+	{ Command::INTERRUPT, N_("Interrupt search") },
 #endif
 #ifdef ENABLE_LYRICS_SCREEN
 	Command::NONE,
@@ -197,6 +205,13 @@ static constexpr HelpRow help_text[] = {
 	HLINE,
 	{ Command::PLAY, N_("Enable/disable output") },
 #endif
+#ifdef ENABLE_PERF_SCREEN
+	Command::NONE,
+	Command::NONE,
+	Heading(N_("Performance screen")),
+	HLINE,
+	{ Command::SCREEN_UPDATE, N_("Reset statistics") },
+#endif
 #ifdef ENABLE_CHAT_SCREEN
 	Command::NONE,
 	Command::NONE,
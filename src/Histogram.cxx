@@ -0,0 +1,86 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "Histogram.hxx"
+
+#include <algorithm>
+
+#include <assert.h>
+
+unsigned
+Histogram::ToBucket(uint32_t value) noexcept
+{
+	if (value < SUB_BUCKETS)
+		/* the first octaves are linear */
+		return value;
+
+	/* the position of the highest bit selects the octave, the
+	   next SUB_BITS bits select the bucket within */
+	const unsigned high = 31 - __builtin_clz(value);
+	const unsigned sub = (value >> (high - SUB_BITS)) & (SUB_BUCKETS - 1);
+	return (high - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+uint32_t
+Histogram::GetBucketMax(unsigned bucket) noexcept
+{
+	if (bucket < SUB_BUCKETS)
+		return bucket;
+
+	const unsigned high = bucket / SUB_BUCKETS + SUB_BITS - 1;
+	const unsigned sub = bucket % SUB_BUCKETS;
+	const uint64_t start = (uint64_t(SUB_BUCKETS + sub)) << (high - SUB_BITS);
+	const uint64_t size = uint64_t(1) << (high - SUB_BITS);
+	return std::min<uint64_t>(start + size - 1, UINT32_MAX);
+}
+
+void
+Histogram::Add(Duration d) noexcept
+{
+	const auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+	const uint32_t value = us <= 0
+		? 0
+		: uint32_t(std::min<decltype(us)>(us, UINT32_MAX));
+
+	++buckets[ToBucket(value)];
+	++count;
+	sum += value;
+	max = std::max(max, value);
+}
+
+unsigned
+Histogram::GetPercentile(unsigned percent) const noexcept
+{
+	assert(percent <= 100);
+
+	if (count == 0)
+		return 0;
+
+	/* the number of samples which must be below the result */
+	const uint64_t rank = (count * percent + 99) / 100;
+
+	uint64_t seen = 0;
+	for (unsigned i = 0; i < N_BUCKETS; ++i) {
+		seen += buckets[i];
+		if (seen >= rank && seen > 0)
+			return std::min(GetBucketMax(i), max);
+	}
+
+	return max;
+}
@@ -0,0 +1,99 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_HISTOGRAM_HXX
+#define NCMPC_HISTOGRAM_HXX
+
+#include "util/Compiler.h"
+
+#include <array>
+#include <chrono>
+
+#include <stdint.h>
+
+/**
+ * A histogram of durations with logarithmic buckets: each power of
+ * two (in microseconds) is split into #SUB_BUCKETS buckets, so
+ * percentiles are accurate to about 25%.  Adding a sample costs a
+ * few instructions and no allocation.
+ */
+class Histogram {
+	static constexpr unsigned SUB_BITS = 2;
+	static constexpr unsigned SUB_BUCKETS = 1u << SUB_BITS;
+	static constexpr unsigned N_BUCKETS = (32 - SUB_BITS + 1) * SUB_BUCKETS;
+
+	std::array<uint32_t, N_BUCKETS> buckets{};
+
+	uint64_t count = 0;
+
+	/**
+	 * The sum of all samples [us].
+	 */
+	uint64_t sum = 0;
+
+	/**
+	 * The largest sample [us].
+	 */
+	uint32_t max = 0;
+
+public:
+	using Duration = std::chrono::steady_clock::duration;
+
+	void Clear() noexcept {
+		*this = Histogram();
+	}
+
+	void Add(Duration d) noexcept;
+
+	uint64_t GetCount() const noexcept {
+		return count;
+	}
+
+	/**
+	 * Returns the mean value [us] or 0 if there are no samples.
+	 */
+	gcc_pure
+	unsigned GetMean() const noexcept {
+		return count > 0 ? sum / count : 0;
+	}
+
+	unsigned GetMax() const noexcept {
+		return max;
+	}
+
+	/**
+	 * Returns the value [us] which is larger than the given
+	 * percentage of all samples (approximately), or 0 if there
+	 * are no samples.
+	 */
+	gcc_pure
+	unsigned GetPercentile(unsigned percent) const noexcept;
+
+private:
+	gcc_const
+	static unsigned ToBucket(uint32_t value) noexcept;
+
+	/**
+	 * Returns the largest value in the given bucket.
+	 */
+	gcc_const
+	static uint32_t GetBucketMax(unsigned bucket) noexcept;
+};
+
+#endif
@@ -0,0 +1,89 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "IncrementalJump.hxx"
+#include "FoldCase.hxx"
+#include "config.h"
+
+#include <assert.h>
+#include <string.h>
+
+IncrementalJump::IncrementalJump(const std::vector<std::string> &_keys,
+				 bool _prefix_only) noexcept
+	:prefix_only(_prefix_only), keys(_keys)
+{
+}
+
+bool
+IncrementalJump::CanNarrow(const char *pattern) noexcept
+{
+#ifdef HAVE_PCRE
+	/* a regular expression may match more when it grows
+	   (e.g. "a" and "a|b") */
+	return strpbrk(pattern, "\\^$.[]|()?*+{}") == nullptr;
+#else
+	(void)pattern;
+	return true;
+#endif
+}
+
+inline bool
+IncrementalJump::Match(const std::string &key,
+		       const std::string &pattern) const noexcept
+{
+	return prefix_only
+		? key.compare(0, pattern.length(), pattern) == 0
+		: FindFolded(key.data(), key.length(), pattern) != nullptr;
+}
+
+int
+IncrementalJump::Find(const char *_pattern) noexcept
+{
+	assert(CanNarrow(_pattern));
+
+	const std::string pattern = FoldCase(_pattern);
+
+	/* discard the steps for strings which have been shortened
+	   (backspace) or replaced */
+	while (!steps.empty() &&
+	       pattern.compare(0, steps.back().pattern.length(),
+			       steps.back().pattern) != 0)
+		steps.pop_back();
+
+	if (steps.empty() || steps.back().pattern != pattern) {
+		std::vector<unsigned> candidates;
+
+		if (steps.empty()) {
+			for (unsigned i = 0; i < keys.size(); ++i)
+				if (Match(keys[i], pattern))
+					candidates.push_back(i);
+		} else {
+			/* a longer string matches only items which
+			   have matched its prefix */
+			for (const unsigned i : steps.back().candidates)
+				if (Match(keys[i], pattern))
+					candidates.push_back(i);
+		}
+
+		steps.push_back({pattern, std::move(candidates)});
+	}
+
+	const auto &candidates = steps.back().candidates;
+	return candidates.empty() ? -1 : (int)candidates.front();
+}
@@ -0,0 +1,96 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_INCREMENTAL_JUMP_HXX
+#define NCMPC_INCREMENTAL_JUMP_HXX
+
+#include "util/Compiler.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Finds the first list item matching a search string which grows
+ * (or shrinks) one character at a time, like in screen_jump().  The
+ * texts of all items are folded with FoldCase() once, and each longer string is
+ * matched only against the items which have matched the shorter
+ * one.
+ *
+ * This works only for plain strings, not for regular expressions;
+ * see CanNarrow().
+ */
+class IncrementalJump {
+	const bool prefix_only;
+
+	/**
+	 * The folded texts of all items.
+	 */
+	const std::vector<std::string> &keys;
+
+	struct Step {
+		/**
+		 * The folded search string.
+		 */
+		std::string pattern;
+
+		/**
+		 * The (ascending) indexes of all items which match
+		 * #pattern.
+		 */
+		std::vector<unsigned> candidates;
+	};
+
+	/**
+	 * One element for each search string which was passed to
+	 * Find(); each one is a prefix of the following ones.
+	 */
+	std::vector<Step> steps;
+
+public:
+	/**
+	 * @param keys the texts of all items, converted with
+	 * FoldCase() (e.g. by #FoldedListTexts); the vector is not
+	 * copied and must remain valid as long as this object exists
+	 * @param prefix_only match only at the beginning of the item
+	 * texts?
+	 */
+	IncrementalJump(const std::vector<std::string> &keys,
+			bool prefix_only) noexcept;
+
+	/**
+	 * Can the given search string be matched by this class?  If
+	 * not, it must be passed to ListWindow::Jump().
+	 */
+	gcc_pure
+	static bool CanNarrow(const char *pattern) noexcept;
+
+	/**
+	 * Find the first item matching the given search string.
+	 *
+	 * @return the item index or -1 if no item matches
+	 */
+	int Find(const char *pattern) noexcept;
+
+private:
+	gcc_pure
+	bool Match(const std::string &key,
+		   const std::string &pattern) const noexcept;
+};
+
+#endif
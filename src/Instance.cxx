@@ -55,6 +55,7 @@ Instance::Instance()
 		options.timeout_ms,
 		options.password.empty() ? nullptr : options.password.c_str()),
 	 seek(io_service, client),
+	 volume(io_service, client),
 	 reconnect_timer(io_service),
 	 update_timer(io_service),
 #ifndef NCMPC_MINI
@@ -97,7 +98,7 @@ Instance::~Instance()
 void
 Instance::Run()
 {
-	screen_manager.Update(client, seek);
+	screen_manager.Update(client, seek, volume);
 
 	io_service.run();
 }
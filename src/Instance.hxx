@@ -24,6 +24,7 @@
 #include "AsyncUserInput.hxx"
 #include "mpdclient.hxx"
 #include "DelayedSeek.hxx"
+#include "DelayedVolume.hxx"
 #include "screen.hxx"
 
 #ifdef ENABLE_LIRC
@@ -49,6 +50,7 @@ class Instance {
 	struct mpdclient client;
 
 	DelayedSeek seek;
+	DelayedVolume volume;
 
 	/**
 	 * This timer is installed when the connection to the MPD
@@ -91,6 +93,10 @@ public:
 		return seek;
 	}
 
+	auto &GetVolume() noexcept {
+		return volume;
+	}
+
 	auto &GetScreenManager() {
 		return screen_manager;
 	}
@@ -42,7 +42,7 @@ class CommandKeysPage final : public ListPage, ListText {
 	ScreenManager &screen;
 	Page *const parent;
 
-	const KeyBindings *bindings;
+	KeyBindings *bindings;
 	KeyBinding *binding;
 
 	/**
@@ -156,6 +156,7 @@ CommandKeysPage::DeleteKey(int key_index)
 	binding->keys[key_index] = 0;
 
 	binding->modified = true;
+	bindings->InvalidateKeyTable();
 	UpdateListLength();
 
 	screen_status_message(_("Deleted"));
@@ -199,6 +200,7 @@ CommandKeysPage::OverwriteKey(int key_index)
 
 	binding->keys[key_index] = key;
 	binding->modified = true;
+	bindings->InvalidateKeyTable();
 
 	screen_status_printf(_("Assigned %s to %s"),
 			     GetLocalizedKeyName(key),
@@ -380,10 +382,7 @@ private:
 bool
 CommandListPage::IsModified() const
 {
-	const auto &orginal_bindings = GetGlobalKeyBindings();
-	constexpr size_t size = sizeof(orginal_bindings);
-
-	return memcmp(&orginal_bindings, &bindings, size) != 0;
+	return !GetGlobalKeyBindings().HasSameKeys(*bindings);
 }
 
 void
@@ -0,0 +1,55 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_LIBRARY_CACHE_HXX
+#define NCMPC_LIBRARY_CACHE_HXX
+
+#include "LruCache.hxx"
+#include "TagFilter.hxx"
+#include "filelist.hxx"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Caches the lists of the library page which are currently not
+ * displayed, so navigating back and forth does not need to ask MPD
+ * again.  It must be cleared when the database changes.
+ */
+struct LibraryCache {
+	using ValuesKey = std::pair<enum mpd_tag_type, TagFilter>;
+
+	/**
+	 * Sorted tag values of a #TagListPage.
+	 */
+	LruCache<ValuesKey, std::vector<std::string>> values{64};
+
+	/**
+	 * The song lists of the #SongListPage.
+	 */
+	LruCache<TagFilter, std::unique_ptr<FileList>> songs{8};
+
+	void Clear() noexcept {
+		values.Clear();
+		songs.Clear();
+	}
+};
+
+#endif
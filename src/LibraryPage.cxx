@@ -19,21 +19,27 @@
 
 #include "LibraryPage.hxx"
 #include "TagListPage.hxx"
+#include "LibraryTree.hxx"
+#include "LibraryCache.hxx"
 #include "PageMeta.hxx"
 #include "FileListPage.hxx"
 #include "Command.hxx"
 #include "ProxyPage.hxx"
+#include "screen_status.hxx"
 #include "i18n.h"
 #include "charset.hxx"
 #include "mpdclient.hxx"
 #include "filelist.hxx"
 #include "Options.hxx"
+#include "PerfStats.hxx"
 
+#include <algorithm>
 #include <list>
 #include <string>
 #include <vector>
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 
 gcc_const
@@ -64,17 +70,51 @@ MakePageTitle(char *buffer, size_t size, const char *prefix,
 	return buffer;
 }
 
+/**
+ * Song lists with more songs than this are loaded lazily in pages
+ * of #SONG_LIST_PAGE_SIZE songs, using the "window" parameter of the
+ * "find" command.
+ */
+static constexpr unsigned SONG_LIST_PAGED_THRESHOLD = 4096;
+
+static constexpr unsigned SONG_LIST_PAGE_SIZE = 256;
+
+/**
+ * The maximum number of pages kept in memory; the least recently
+ * used ones are freed.
+ */
+static constexpr unsigned SONG_LIST_MAX_PAGES = 32;
+
 class SongListPage final : public FileListPage {
 	Page *const parent;
 
+	/**
+	 * The song list of the previous filter is stored here when
+	 * the filter changes.
+	 */
+	LibraryCache &cache;
+
 	TagFilter filter;
 
+	/**
+	 * The number of songs in a paged list; 0 if the whole list
+	 * was loaded at once.
+	 */
+	unsigned n_songs = 0;
+
+	/**
+	 * The pages of a paged list which are currently loaded, the
+	 * most recently used first.
+	 */
+	std::list<unsigned> loaded_pages;
+
 public:
 	SongListPage(ScreenManager &_screen, Page *_parent,
+		     LibraryCache &_cache,
 		     WINDOW *_w, Size size) noexcept
 		:FileListPage(_screen, _w, size,
 			      options.list_format.c_str()),
-		 parent(_parent) {}
+		 parent(_parent), cache(_cache) {}
 
 	const auto &GetFilter() const noexcept {
 		return filter;
@@ -82,27 +122,97 @@ public:
 
 	template<typename F>
 	void SetFilter(F &&_filter) noexcept {
+		/* this is a different list; don't merge with the old
+		   one */
+		StashSongList();
+		ClearFilter();
+
 		filter = std::forward<F>(_filter);
 		AddPendingEvents(~0u);
 	}
 
 	void LoadSongList(struct mpdclient &c);
 
+private:
+	bool IsPaged() const noexcept {
+		return n_songs > 0;
+	}
+
+	/**
+	 * Move the song list to the #LibraryCache (if it is complete
+	 * and up-to-date) and clear it.
+	 */
+	void StashSongList() noexcept;
+
+	/**
+	 * Ask MPD how many songs match the filter.
+	 *
+	 * @return the number of songs or 0 on error
+	 */
+	unsigned CountSongs(struct mpdclient &c) noexcept;
+
+	void LoadPage(struct mpdclient &c, unsigned page) noexcept;
+
+	/**
+	 * Add all songs matching the filter to the queue.
+	 */
+	void AddAll(struct mpdclient &c) noexcept;
+
+	/**
+	 * Make sure all pages of a paged list which overlap the
+	 * given range are loaded.
+	 */
+	void LoadRange(struct mpdclient &c,
+		       unsigned start, unsigned end) noexcept;
+
+	/**
+	 * Load the pages around the visible part of a paged list and
+	 * free the least recently used pages.
+	 */
+	void LoadVisible(struct mpdclient &c) noexcept;
+
+protected:
+	/* virtual methods from class FileListPage */
+	bool CanFilter() const noexcept override {
+		return !IsPaged();
+	}
+
+public:
 	/* virtual methods from class Page */
 	void Update(struct mpdclient &c, unsigned events) noexcept override;
 	bool OnCommand(struct mpdclient &c, Command cmd) override;
 	const char *GetTitle(char *s, size_t size) const noexcept override;
+
+#ifdef HAVE_GETMOUSE
+	bool OnMouse(struct mpdclient &c, Point p,
+		     mmask_t bstate) override;
+#endif
 };
 
 void
 SongListPage::Update(struct mpdclient &c, unsigned events) noexcept
 {
+	if (c.IsUpdatingDatabase() && (events & MPD_IDLE_UPDATE) == 0)
+		/* a database update is still running: reload only
+		   once after it has finished */
+		PostponeEvents(events, MPD_IDLE_DATABASE);
+
 	if (events & MPD_IDLE_DATABASE) {
 		LoadSongList(c);
+	} else if (events & MPD_IDLE_QUEUE && !IsPaged()) {
+		if (SyncHighlights(c.playlist))
+			SetDirty();
 	}
+
+	if (IsPaged())
+		/* this also synchronizes the highlights */
+		LoadVisible(c);
 }
 
 class ArtistBrowserPage final : public ProxyPage {
+	LibraryTree tree;
+	LibraryCache cache;
+
 	std::list<TagListPage> tag_list_pages;
 	std::list<TagListPage>::iterator current_tag_list_page;
 
@@ -112,18 +222,26 @@ public:
 	ArtistBrowserPage(ScreenManager &_screen, WINDOW *_w,
 			  Size size)
 		:ProxyPage(_w),
-		 song_list_page(_screen, this,
+		 tree(options.library_page_tags),
+		 song_list_page(_screen, this, cache,
 				_w, size) {
 
 		bool first = true;
 		for (const auto &tag : options.library_page_tags) {
 			tag_list_pages.emplace_back(_screen,
 						    first ? nullptr : this,
+						    &tree, &cache,
 						    tag,
 						    first ? nullptr : _("All"),
 						    _w, size);
 			first = false;
 		}
+
+		perf_stats.library_cache = &cache;
+	}
+
+	~ArtistBrowserPage() noexcept override {
+		perf_stats.library_cache = nullptr;
 	}
 
 private:
@@ -138,30 +256,232 @@ public:
 	bool OnCommand(struct mpdclient &c, Command cmd) override;
 };
 
+unsigned
+SongListPage::CountSongs(struct mpdclient &c) noexcept
+{
+	if (filter.empty())
+		/* old MPD versions reject "count" without arguments */
+		return 0;
+
+#if LIBMPDCLIENT_CHECK_VERSION(2,10,0)
+	auto *connection = c.GetConnection();
+	if (connection == nullptr ||
+	    /* "window" requires MPD 0.20 */
+	    mpd_connection_cmp_server_version(connection, 0, 20, 0) < 0)
+		return 0;
+
+	mpd_count_db_songs(connection);
+	AddConstraints(connection, filter);
+	mpd_search_commit(connection);
+
+	unsigned n = 0;
+	auto *pair = mpd_recv_pair_named(connection, "songs");
+	if (pair != nullptr) {
+		n = strtoul(pair->value, nullptr, 10);
+		mpd_return_pair(connection, pair);
+	}
+
+	if (!c.FinishCommand())
+		return 0;
+
+	return n;
+#else
+	/* paging requires mpd_search_add_window(), which was added
+	   in libmpdclient 2.10; load the whole list instead */
+	(void)c;
+	return 0;
+#endif
+}
+
 void
-SongListPage::LoadSongList(struct mpdclient &c)
+SongListPage::LoadPage(struct mpdclient &c, unsigned page) noexcept
+{
+	auto *connection = c.GetConnection();
+	if (connection == nullptr)
+		return;
+
+	const unsigned start = page * SONG_LIST_PAGE_SIZE;
+	const unsigned end = std::min(start + SONG_LIST_PAGE_SIZE, n_songs);
+
+	mpd_search_db_songs(connection, true);
+	AddConstraints(connection, filter);
+#if LIBMPDCLIENT_CHECK_VERSION(2,10,0)
+	mpd_search_add_window(connection, start, end);
+#else
+	/* unreachable: CountSongs() never enables paging */
+	(void)end;
+#endif
+	mpd_search_commit(connection);
+
+	/* the first entry is ".." */
+	unsigned i = 1 + start;
+
+	struct mpd_entity *entity;
+	while ((entity = mpd_recv_entity(connection)) != nullptr) {
+		++perf_stats.entities_received;
+
+		if (i < filelist->size())
+			(*filelist)[i++].Load(entity);
+		else
+			/* the database has grown meanwhile; the
+			   next MPD_IDLE_DATABASE will fix it */
+			mpd_entity_free(entity);
+	}
+
+	/* track the page even if the command has failed, so it is
+	   not requested again on every scroll; its placeholders will
+	   be retried after the page has been evicted */
+	loaded_pages.push_front(page);
+	InvalidateCaches();
+	SetDirty();
+
+	c.FinishCommand();
+}
+
+void
+SongListPage::AddAll(struct mpdclient &c) noexcept
 {
 	auto *connection = c.GetConnection();
+	if (connection == nullptr)
+		return;
+
+	mpd_search_add_db_songs(connection, true);
+	AddConstraints(connection, filter);
+	mpd_search_commit(connection);
+
+	if (c.FinishCommand())
+		screen_status_printf(_("Adding \'%s\' to queue"),
+				     Utf8ToLocale(ToString(filter).c_str()).c_str());
+}
+
+void
+SongListPage::LoadRange(struct mpdclient &c,
+			unsigned start, unsigned end) noexcept
+{
+	if (start > 0)
+		/* skip ".." */
+		--start;
+	if (end > 0)
+		--end;
+
+	end = std::min(end, n_songs);
+	if (start >= end)
+		return;
+
+	for (unsigned page = start / SONG_LIST_PAGE_SIZE;
+	     page <= (end - 1) / SONG_LIST_PAGE_SIZE; ++page) {
+		auto i = std::find(loaded_pages.begin(), loaded_pages.end(),
+				   page);
+		if (i != loaded_pages.end())
+			/* mark as recently used */
+			loaded_pages.splice(loaded_pages.begin(),
+					    loaded_pages, i);
+		else
+			LoadPage(c, page);
+	}
+}
+
+void
+SongListPage::LoadVisible(struct mpdclient &c) noexcept
+{
+	/* prefetch one screen above and below the visible part */
+	const unsigned height = lw.GetHeight();
+	const unsigned origin = lw.GetOrigin();
+	LoadRange(c, origin > height ? origin - height : 0,
+		  origin + 2 * height);
+
+	/* the cursor may be outside of the visible part, e.g. in
+	   range selection mode */
+	const auto range = lw.GetRange();
+	LoadRange(c, range.start_index,
+		  std::min(range.end_index, range.start_index + height));
+
+	while (loaded_pages.size() > SONG_LIST_MAX_PAGES) {
+		const unsigned start = 1 + loaded_pages.back() * SONG_LIST_PAGE_SIZE;
+		const unsigned end = std::min<unsigned>(start + SONG_LIST_PAGE_SIZE,
+							filelist->size());
+		for (unsigned i = start; i < end; ++i)
+			(*filelist)[i].Unload();
+
+		loaded_pages.pop_back();
+		InvalidateCaches();
+	}
+
+	if (SyncHighlights(c.playlist))
+		SetDirty();
+}
 
-	delete filelist;
+void
+SongListPage::StashSongList() noexcept
+{
+	if (filelist != nullptr && !IsPaged() &&
+	    !HasPendingEvents(MPD_IDLE_DATABASE))
+		cache.songs.Put(TagFilter(filter),
+				std::unique_ptr<FileList>(filelist));
+	else
+		delete filelist;
+
+	filelist = nullptr;
+}
 
-	filelist = new FileList();
+void
+SongListPage::LoadSongList(struct mpdclient &c)
+{
+	std::unique_ptr<FileList> cached;
+	if (filelist == nullptr && cache.songs.Take(filter, cached)) {
+		/* this list was displayed recently and the database
+		   has not changed since */
+		n_songs = 0;
+		loaded_pages.clear();
+		ReplaceFileList(cached.release());
+		if (SyncHighlights(c.playlist))
+			SetDirty();
+		return;
+	}
+
+	loaded_pages.clear();
+	n_songs = CountSongs(c);
+	if (n_songs >= SONG_LIST_PAGED_THRESHOLD) {
+		/* too many songs to load at once: create
+		   placeholders and load only the visible pages;
+		   these cannot be filtered */
+		ClearFilter();
+		delete filelist;
+		filelist = new FileList();
+		InvalidateCaches();
+		/* add a dummy entry for ".." */
+		filelist->emplace_back(nullptr);
+		filelist->AppendPlaceholders(n_songs);
+
+		lw.SetLength(filelist->size());
+		LoadVisible(c);
+		SetDirty();
+		return;
+	}
+
+	n_songs = 0;
+
+	auto *connection = c.GetConnection();
+
+	auto *new_filelist = new FileList();
 	/* add a dummy entry for ".." */
-	filelist->emplace_back(nullptr);
+	new_filelist->emplace_back(nullptr);
 
 	if (connection != nullptr) {
 		mpd_search_db_songs(connection, true);
 		AddConstraints(connection, filter);
 		mpd_search_commit(connection);
 
-		filelist->Receive(*connection);
+		new_filelist->Receive(*connection);
 
 		c.FinishCommand();
 	}
 
+	ReplaceFileList(new_filelist);
+
 	/* fix highlights */
-	screen_browser_sync_highlights(filelist, &c.playlist);
-	lw.SetLength(filelist->size());
+	if (SyncHighlights(c.playlist))
+		SetDirty();
 }
 
 void
@@ -204,7 +524,8 @@ SongListPage::OnCommand(struct mpdclient &c, Command cmd)
 {
 	switch(cmd) {
 	case Command::PLAY:
-		if (lw.GetCursorIndex() == 0 && parent != nullptr)
+		if (lw.GetCursorIndex() == 0 && parent != nullptr &&
+		    GetIndex(0) != nullptr && GetIndex(0)->IsParent())
 			/* handle ".." */
 			return parent->OnCommand(c, Command::GO_PARENT_DIRECTORY);
 
@@ -215,13 +536,54 @@ SongListPage::OnCommand(struct mpdclient &c, Command cmd)
 		LoadSongList(c);
 		return false;
 
+	case Command::SELECT:
+	case Command::ADD:
+		if (IsPaged()) {
+			/* the whole selection needs to be loaded */
+			const auto range = lw.GetRange();
+			LoadRange(c, range.start_index, range.end_index);
+		}
+
+		break;
+
+	case Command::SELECT_ALL:
+		if (IsPaged()) {
+			/* add all songs with one "findadd" instead of
+			   loading all pages */
+			AddAll(c);
+			return true;
+		}
+
+		break;
+
 	default:
 		break;
 	}
 
-	return FileListPage::OnCommand(c, cmd);
+	bool result = FileListPage::OnCommand(c, cmd);
+
+	if (IsPaged())
+		/* the cursor may have moved */
+		LoadVisible(c);
+
+	return result;
 }
 
+#ifdef HAVE_GETMOUSE
+
+bool
+SongListPage::OnMouse(struct mpdclient &c, Point p, mmask_t bstate)
+{
+	bool result = FileListPage::OnMouse(c, p, bstate);
+
+	if (IsPaged())
+		LoadVisible(c);
+
+	return result;
+}
+
+#endif
+
 void
 ArtistBrowserPage::OnOpen(struct mpdclient &c) noexcept
 {
@@ -239,6 +601,12 @@ ArtistBrowserPage::OnOpen(struct mpdclient &c) noexcept
 void
 ArtistBrowserPage::Update(struct mpdclient &c, unsigned events) noexcept
 {
+	if (events & MPD_IDLE_DATABASE) {
+		/* reloaded on demand by the next TagListPage update */
+		tree.Clear();
+		cache.Clear();
+	}
+
 	for (auto &i : tag_list_pages)
 		i.AddPendingEvents(events);
 	song_list_page.AddPendingEvents(events);
@@ -0,0 +1,190 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "LibraryTree.hxx"
+#include "SortKey.hxx"
+#include "mpdclient.hxx"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+
+#include <string.h>
+
+void
+LibraryTree::Node::Finish() noexcept
+{
+	const auto order = SortByKeys(children.size(), [this](size_t i){
+			return MakeSortKey(children[i].value.c_str());
+		});
+
+	std::vector<Node> sorted;
+	sorted.reserve(children.size());
+
+	for (unsigned i : order) {
+		auto &child = children[i];
+		if (!sorted.empty() && sorted.back().value == child.value) {
+			/* MPD has sent this value twice (under the same
+			   parent); merge both */
+			auto &dest = sorted.back().children;
+			std::move(child.children.begin(), child.children.end(),
+				  std::back_inserter(dest));
+		} else
+			sorted.emplace_back(std::move(child));
+	}
+
+	children = std::move(sorted);
+
+	by_value.resize(children.size());
+	std::iota(by_value.begin(), by_value.end(), 0);
+	std::sort(by_value.begin(), by_value.end(),
+		  [this](unsigned a, unsigned b){
+			  return children[a].value < children[b].value;
+		  });
+
+	for (auto &child : children)
+		child.Finish();
+}
+
+const LibraryTree::Node *
+LibraryTree::Node::FindChild(const char *_value) const noexcept
+{
+	const auto i = std::lower_bound(by_value.begin(), by_value.end(),
+					_value,
+					[this](unsigned a, const char *b){
+						return strcmp(children[a].value.c_str(),
+							      b) < 0;
+					});
+	if (i == by_value.end() || children[*i].value != _value)
+		return nullptr;
+
+	return &children[*i];
+}
+
+void
+LibraryTree::Clear() noexcept
+{
+	root.children.clear();
+	root.children.shrink_to_fit();
+	root.by_value.clear();
+	root.by_value.shrink_to_fit();
+	loaded = failed = false;
+}
+
+bool
+LibraryTree::Load(struct mpdclient &c) noexcept
+{
+	if (loaded)
+		return true;
+
+	if (failed || tags.empty())
+		return false;
+
+#if LIBMPDCLIENT_CHECK_VERSION(2,12,0)
+	auto *connection = c.GetConnection();
+	if (connection == nullptr)
+		return false;
+
+	if (tags.size() > 1 &&
+	    /* multiple "group" parameters require MPD 0.21 */
+	    mpd_connection_cmp_server_version(connection, 0, 21, 0) < 0) {
+		failed = true;
+		return false;
+	}
+
+	/* e.g. "list album group artist" */
+	mpd_search_db_tags(connection, tags.back());
+	for (auto i = std::next(tags.rbegin()); i != tags.rend(); ++i)
+		mpd_search_add_group_tag(connection, *i);
+	mpd_search_commit(connection);
+
+	/* the most recent node of each level; a group value is only
+	   sent when it changes */
+	std::vector<Node *> current(tags.size() + 1, nullptr);
+	current.front() = &root;
+
+	struct mpd_pair *pair;
+	while ((pair = mpd_recv_pair(connection)) != nullptr) {
+		const auto tag = mpd_tag_name_iparse(pair->name);
+		const auto t = std::find(tags.begin(), tags.end(), tag);
+		if (t != tags.end()) {
+			const size_t level = std::distance(tags.begin(), t);
+			Node *parent = current[level];
+			if (parent != nullptr) {
+				parent->children.emplace_back(pair->value);
+				current[level + 1] = &parent->children.back();
+				std::fill(std::next(current.begin(), level + 2),
+					  current.end(), nullptr);
+			}
+		}
+
+		mpd_return_pair(connection, pair);
+	}
+
+	if (!c.FinishCommand()) {
+		root.children.clear();
+		failed = true;
+		return false;
+	}
+
+	root.Finish();
+	loaded = true;
+	return true;
+#else
+	(void)c;
+	failed = true;
+	return false;
+#endif
+}
+
+bool
+LibraryTree::Find(enum mpd_tag_type tag, const TagFilter &filter,
+		  std::vector<std::string> &values) const noexcept
+{
+	if (!loaded)
+		return false;
+
+	const auto t = std::find(tags.begin(), tags.end(), tag);
+	if (t == tags.end())
+		return false;
+
+	const size_t level = std::distance(tags.begin(), t);
+	if ((size_t)std::distance(filter.begin(), filter.end()) != level)
+		/* the filter contains something which is not in the
+		   tree */
+		return false;
+
+	const Node *node = &root;
+	for (size_t i = 0; i < level; ++i) {
+		const char *value = FindTag(filter, tags[i]);
+		if (value == nullptr)
+			return false;
+
+		node = node->FindChild(value);
+		if (node == nullptr)
+			/* not found: the list is empty */
+			return true;
+	}
+
+	values.reserve(values.size() + node->children.size());
+	for (const auto &child : node->children)
+		values.emplace_back(child.value);
+
+	return true;
+}
@@ -0,0 +1,109 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_LIBRARY_TREE_HXX
+#define NCMPC_LIBRARY_TREE_HXX
+
+#include "TagFilter.hxx"
+#include "util/Compiler.h"
+
+#include <mpd/tag.h>
+
+#include <string>
+#include <vector>
+
+struct mpdclient;
+
+/**
+ * An in-memory copy of the tag hierarchy shown on the library page
+ * (see option "library-page-tags"), loaded with one grouped "list"
+ * command.  This allows navigating the hierarchy without asking MPD
+ * again.
+ */
+class LibraryTree {
+	struct Node {
+		std::string value;
+
+		/**
+		 * The values of the next level, sorted.  This is
+		 * empty on the last level.
+		 */
+		std::vector<Node> children;
+
+		/**
+		 * Indexes into #children, ordered by their values
+		 * (byte-wise), for looking up a value with a binary
+		 * search; #children itself is sorted by collation
+		 * key, which cannot be searched for a value.
+		 */
+		std::vector<unsigned> by_value;
+
+		Node() = default;
+
+		explicit Node(const char *_value)
+			:value(_value) {}
+
+		void Finish() noexcept;
+
+		gcc_pure
+		const Node *FindChild(const char *value) const noexcept;
+	};
+
+	const std::vector<enum mpd_tag_type> tags;
+
+	Node root;
+
+	bool loaded = false;
+
+	/**
+	 * Set if loading has failed (e.g. because MPD does not
+	 * support grouping); don't try again until Clear() is
+	 * called.
+	 */
+	bool failed = false;
+
+public:
+	explicit LibraryTree(const std::vector<enum mpd_tag_type> &_tags) noexcept
+		:tags(_tags) {}
+
+	/**
+	 * Discard the tree, e.g. because the database has changed.
+	 */
+	void Clear() noexcept;
+
+	/**
+	 * Load the tree from MPD unless it is already loaded.
+	 *
+	 * @return false if the tree is not available
+	 */
+	bool Load(struct mpdclient &c) noexcept;
+
+	/**
+	 * Look up the values of the given tag which match the
+	 * filter.
+	 *
+	 * @param values the sorted values are appended to this list
+	 * @return false if the tree cannot answer this query (the
+	 * caller should ask MPD instead)
+	 */
+	bool Find(enum mpd_tag_type tag, const TagFilter &filter,
+		  std::vector<std::string> &values) const noexcept;
+};
+
+#endif
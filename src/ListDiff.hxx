@@ -0,0 +1,120 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_LIST_DIFF_HXX
+#define NCMPC_LIST_DIFF_HXX
+
+#include "ListCursor.hxx"
+
+#include <vector>
+
+/**
+ * The result of comparing an old version of a list with a new one.
+ */
+struct ListDiff {
+	/**
+	 * For each item of the old list (plus one for the end of
+	 * the list), the position of the same item in the new list,
+	 * or of its successor if the item was removed.
+	 */
+	std::vector<unsigned> map;
+
+	unsigned inserted = 0, removed = 0;
+
+	bool empty() const noexcept {
+		return inserted == 0 && removed == 0;
+	}
+
+	/**
+	 * Translate a position in the old list to a position in the
+	 * new list.  Positions after the end of the old list (e.g.
+	 * virtual items) are shifted by the difference.
+	 */
+	gcc_pure
+	unsigned Translate(unsigned i) const noexcept {
+		const unsigned old_size = map.size() - 1;
+		return i < old_size
+			? map[i]
+			: map.back() + (i - old_size);
+	}
+};
+
+/**
+ * Compare two lists which are not sorted, but whose surviving items
+ * retain their relative order.
+ *
+ * Moved items are not detected: if an item has moved, the items it
+ * has been moved across are reported as removed and inserted, so a
+ * cursor on one of them jumps to the next item which was matched.
+ *
+ * @param same a function checking whether item i of the old list is
+ * the same as item j of the new list
+ * @param old_in_new a function checking whether item i of the old
+ * list exists in the new list
+ * @param new_in_old a function checking whether item j of the new
+ * list exists in the old list
+ */
+template<typename S, typename O, typename N>
+ListDiff
+DiffLists(unsigned old_size, unsigned new_size,
+	  S &&same, O &&old_in_new, N &&new_in_old) noexcept
+{
+	ListDiff diff;
+	diff.map.reserve(old_size + 1);
+
+	unsigned j = 0;
+	for (unsigned i = 0; i < old_size;) {
+		if (j < new_size && same(i, j)) {
+			diff.map.push_back(j++);
+			++i;
+		} else if (j < new_size && old_in_new(i) && !new_in_old(j)) {
+			/* inserted */
+			++diff.inserted;
+			++j;
+		} else {
+			/* removed (or moved, which is treated as
+			   removal plus insertion) */
+			diff.map.push_back(j);
+			++diff.removed;
+			++i;
+		}
+	}
+
+	diff.inserted += new_size - j;
+	diff.map.push_back(new_size);
+	return diff;
+}
+
+/**
+ * Adjust the cursor and the scroll position of a list after its
+ * items have been replaced, so both stay on the same items.
+ */
+inline void
+ApplyListDiff(ListCursor &cursor, const ListDiff &diff,
+	      unsigned new_length) noexcept
+{
+	const unsigned selected = diff.Translate(cursor.GetCursorIndex());
+	const unsigned origin = diff.Translate(cursor.GetOrigin());
+
+	cursor.SetLength(new_length);
+	cursor.SetOrigin(origin);
+	cursor.SetCursor(selected);
+}
+
+#endif
@@ -0,0 +1,96 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ListFilter.hxx"
+
+void
+ListFilter::OnInsert(unsigned position) noexcept
+{
+	if (!IsActive())
+		return;
+
+	auto i = LowerBound(position);
+	Shift(i, rows.end(), 1);
+	rows.insert(i, {position, true});
+}
+
+void
+ListFilter::OnRemove(unsigned start, unsigned end) noexcept
+{
+	assert(start <= end);
+
+	if (!IsActive())
+		return;
+
+	auto i = rows.erase(LowerBound(start), LowerBound(end));
+	Shift(i, rows.end(), -int(end - start));
+}
+
+void
+ListFilter::OnReplace(unsigned position) noexcept
+{
+	if (!IsActive())
+		return;
+
+	auto i = LowerBound(position);
+	if (i != rows.end() && i->position == position)
+		i->pending = true;
+	else
+		rows.insert(i, {position, true});
+}
+
+void
+ListFilter::OnMove(unsigned dest, unsigned src) noexcept
+{
+	if (!IsActive() || dest == src)
+		return;
+
+	auto i = LowerBound(src);
+	const bool visible = i != rows.end() && i->position == src;
+	const bool pending = visible && i->pending;
+
+	/* remove the old row (if any), shift the rows after it,
+	   then insert the row at its new position */
+	if (visible)
+		i = rows.erase(i);
+	Shift(i, rows.end(), -1);
+
+	i = LowerBound(dest);
+	Shift(i, rows.end(), 1);
+	if (visible)
+		rows.insert(i, {dest, pending});
+}
+
+void
+ListFilter::OnReorder(unsigned start, unsigned end) noexcept
+{
+	assert(start <= end);
+
+	if (!IsActive())
+		return;
+
+	auto i = rows.erase(LowerBound(start), LowerBound(end));
+
+	std::vector<Row> reordered;
+	reordered.reserve(end - start);
+	for (unsigned p = start; p < end; ++p)
+		reordered.push_back({p, true});
+
+	rows.insert(i, reordered.begin(), reordered.end());
+}
@@ -0,0 +1,213 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_LIST_FILTER_HXX
+#define NCMPC_LIST_FILTER_HXX
+
+#include "util/Compiler.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <assert.h>
+
+/**
+ * Maps the rows of a filtered list, which shows only the items
+ * matching a pattern, to the positions of these items in the
+ * underlying container.  When the filter is not active, rows and
+ * positions are the same.
+ *
+ * The On*() methods follow modifications of the container without
+ * matching the items again; they only mark inserted or modified
+ * items as "pending", and Commit() matches just those.
+ */
+class ListFilter {
+	std::string pattern;
+
+	struct Row {
+		unsigned position;
+
+		/**
+		 * Has this item been inserted or modified since the
+		 * last Commit()?  Then it has not been matched yet.
+		 */
+		bool pending;
+	};
+
+	/**
+	 * The visible rows, ordered by position.
+	 */
+	std::vector<Row> rows;
+
+public:
+	bool IsActive() const noexcept {
+		return !pattern.empty();
+	}
+
+	const std::string &GetPattern() const noexcept {
+		return pattern;
+	}
+
+	void Clear() noexcept {
+		pattern.clear();
+		rows.clear();
+	}
+
+	/**
+	 * Set a new pattern and match all items.
+	 *
+	 * @param match a function which determines whether the item
+	 * at the given position matches
+	 */
+	template<typename F>
+	void Set(std::string &&_pattern, unsigned length, F &&match) {
+		assert(!_pattern.empty());
+
+		pattern = std::move(_pattern);
+		Refresh(length, match);
+	}
+
+	/**
+	 * Match all items again, e.g. after the container has been
+	 * replaced.
+	 */
+	template<typename F>
+	void Refresh(unsigned length, F &&match) {
+		rows.clear();
+
+		if (!IsActive())
+			return;
+
+		for (unsigned i = 0; i < length; ++i)
+			if (match(i))
+				rows.push_back({i, false});
+	}
+
+	/**
+	 * Match all pending items; remove those which don't match.
+	 */
+	template<typename F>
+	void Commit(F &&match) {
+		rows.erase(std::remove_if(rows.begin(), rows.end(),
+					  [&match](Row &row){
+						  if (!row.pending)
+							  return false;
+
+						  row.pending = false;
+						  return !match(row.position);
+					  }),
+			   rows.end());
+	}
+
+	/**
+	 * Returns the number of rows in a container with the given
+	 * number of items.
+	 */
+	gcc_pure
+	unsigned GetRowCount(unsigned length) const noexcept {
+		return IsActive() ? rows.size() : length;
+	}
+
+	/**
+	 * Convert a row number to a position in the container.
+	 */
+	gcc_pure
+	unsigned ToPosition(unsigned row) const noexcept {
+		if (!IsActive())
+			return row;
+
+		assert(row < rows.size());
+		assert(!rows[row].pending);
+		return rows[row].position;
+	}
+
+	/**
+	 * Convert a position in the container to a row number.
+	 *
+	 * @return the row number or -1 if the item is filtered out
+	 */
+	gcc_pure
+	int ToRow(unsigned position) const noexcept {
+		if (!IsActive())
+			return position;
+
+		const auto i = LowerBound(position);
+		return i != rows.end() && i->position == position
+			? int(std::distance(rows.begin(), i))
+			: -1;
+	}
+
+	/**
+	 * An item has been inserted at the given position.
+	 */
+	void OnInsert(unsigned position) noexcept;
+
+	/**
+	 * The items in the range [start, end) have been removed.
+	 */
+	void OnRemove(unsigned start, unsigned end) noexcept;
+
+	/**
+	 * The item at the given position has been modified.
+	 */
+	void OnReplace(unsigned position) noexcept;
+
+	/**
+	 * The item at position #src has been moved to position
+	 * #dest.
+	 */
+	void OnMove(unsigned dest, unsigned src) noexcept;
+
+	/**
+	 * The items in the range [start, end) have been rearranged.
+	 */
+	void OnReorder(unsigned start, unsigned end) noexcept;
+
+private:
+	gcc_pure
+	std::vector<Row>::const_iterator
+	LowerBound(unsigned position) const noexcept {
+		return std::lower_bound(rows.begin(), rows.end(), position,
+					[](const Row &row, unsigned p){
+						return row.position < p;
+					});
+	}
+
+	gcc_pure
+	std::vector<Row>::iterator LowerBound(unsigned position) noexcept {
+		return std::lower_bound(rows.begin(), rows.end(), position,
+					[](const Row &row, unsigned p){
+						return row.position < p;
+					});
+	}
+
+	/**
+	 * Add a (signed) offset to the positions of all rows
+	 * starting at the given one.
+	 */
+	static void Shift(std::vector<Row>::iterator i,
+			  std::vector<Row>::iterator end,
+			  int offset) noexcept {
+		for (; i != end; ++i)
+			i->position += offset;
+	}
+};
+
+#endif
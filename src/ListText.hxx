@@ -22,6 +22,9 @@
 
 #include "util/Compiler.h"
 
+#include <string>
+#include <vector>
+
 #include <stddef.h>
 
 class ListText {
@@ -32,6 +35,20 @@ public:
 	gcc_pure
 	virtual const char *GetListItemText(char *buffer, size_t size,
 					    unsigned i) const noexcept = 0;
+
+	/**
+	 * Returns the texts of all #length items (like
+	 * GetListItemText()), if this object keeps a cache of them.
+	 * This allows searching the list repeatedly without
+	 * formatting each item again.
+	 *
+	 * @param folded return the texts converted with FoldCase()?
+	 * @return nullptr if there is no cache
+	 */
+	virtual const std::vector<std::string> *
+	GetCachedListItemTexts(unsigned, bool) const noexcept {
+		return nullptr;
+	}
 };
 
 #endif
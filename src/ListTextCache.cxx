@@ -0,0 +1,83 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "ListTextCache.hxx"
+#include "ListText.hxx"
+#include "FoldCase.hxx"
+
+#include <assert.h>
+
+const std::vector<std::string> &
+ListTextCache::Get(const ListText &text, unsigned length,
+		   bool fold) noexcept
+{
+	if (!valid || texts.size() != length) {
+		texts.clear();
+		texts.reserve(length);
+
+		for (unsigned i = 0; i < length; ++i) {
+			char buffer[1024];
+			const char *label =
+				text.GetListItemText(buffer, sizeof(buffer),
+						     i);
+			assert(label != nullptr);
+
+			texts.emplace_back(label);
+		}
+
+		valid = true;
+		folded_valid = false;
+	}
+
+	if (!fold)
+		return texts;
+
+	if (!folded_valid) {
+		folded.clear();
+		folded.reserve(length);
+
+		for (const auto &i : texts)
+			folded.emplace_back(FoldCase(i.c_str()));
+
+		folded_valid = true;
+	}
+
+	return folded;
+}
+
+FoldedListTexts::FoldedListTexts(const ListText &text,
+				 unsigned length) noexcept
+	:texts(text.GetCachedListItemTexts(length, true))
+{
+	if (texts != nullptr)
+		return;
+
+	owned.reserve(length);
+
+	for (unsigned i = 0; i < length; ++i) {
+		char buffer[1024];
+		const char *label =
+			text.GetListItemText(buffer, sizeof(buffer), i);
+		assert(label != nullptr);
+
+		owned.emplace_back(FoldCase(label));
+	}
+
+	texts = &owned;
+}
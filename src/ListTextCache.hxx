@@ -0,0 +1,81 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_LIST_TEXT_CACHE_HXX
+#define NCMPC_LIST_TEXT_CACHE_HXX
+
+#include <string>
+#include <vector>
+
+class ListText;
+
+/**
+ * A cache of all item texts of a #ListText, for implementing
+ * ListText::GetCachedListItemTexts().  The owner must call
+ * Invalidate() whenever the list contents change.
+ */
+class ListTextCache {
+	std::vector<std::string> texts;
+
+	/**
+	 * The #texts converted with FoldCase(); built on demand.
+	 */
+	std::vector<std::string> folded;
+
+	bool valid = false, folded_valid = false;
+
+public:
+	void Invalidate() noexcept {
+		valid = folded_valid = false;
+	}
+
+	/**
+	 * Return the cached texts, and build the cache if it is not
+	 * valid.
+	 *
+	 * @param fold return the texts converted with FoldCase()?
+	 */
+	const std::vector<std::string> &Get(const ListText &text,
+					    unsigned length,
+					    bool fold=false) noexcept;
+};
+
+/**
+ * The texts of all items converted with FoldCase().  If the
+ * #ListText has a cache, this refers to it instead of copying it;
+ * then the #ListText must not be modified while this object exists.
+ * Otherwise, the texts are built and owned by this object.
+ */
+class FoldedListTexts {
+	std::vector<std::string> owned;
+
+	const std::vector<std::string> *texts;
+
+public:
+	FoldedListTexts(const ListText &text, unsigned length) noexcept;
+
+	FoldedListTexts(const FoldedListTexts &) = delete;
+	FoldedListTexts &operator=(const FoldedListTexts &) = delete;
+
+	const std::vector<std::string> &operator*() const noexcept {
+		return *texts;
+	}
+};
+
+#endif
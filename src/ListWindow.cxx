@@ -27,8 +27,14 @@
 #include "paint.hxx"
 #include "screen_status.hxx"
 #include "screen_utils.hxx"
+#include "Parallel.hxx"
+#include "PerfStats.hxx"
 #include "i18n.h"
 
+#include <atomic>
+#include <string>
+#include <vector>
+
 #include <assert.h>
 
 void
@@ -54,6 +60,7 @@ ListWindow::Paint(const ListRenderer &renderer) const noexcept
 			range.Contains(j);
 
 		renderer.PaintListItem(w, j, i, width, is_selected);
+		++perf_stats.frame_rows_painted;
 	}
 
 	row_color_end(w);
@@ -64,47 +71,213 @@ ListWindow::Paint(const ListRenderer &renderer) const noexcept
 	}
 }
 
+/**
+ * Lists with at least this many cached texts are searched in several
+ * threads.
+ */
+static constexpr size_t PARALLEL_FIND_THRESHOLD = 16384;
+
+/**
+ * Matches the items of a #ListText against an expression, using the
+ * cached texts if the #ListText provides them.
+ */
+class ListSearch {
+	/* the matcher works on folded texts; let the #ListText cache
+	   them, instead of folding each text in each search */
+	static constexpr bool folded = true;
+
+	const ListText &text;
+	const std::vector<std::string> *const texts;
+	const MatchExpression &m;
+
+public:
+	ListSearch(const ListText &_text, unsigned length,
+		   const MatchExpression &_m) noexcept
+		:text(_text),
+		 texts(text.GetCachedListItemTexts(length, folded)),
+		 m(_m) {
+		assert(texts == nullptr || texts->size() == length);
+	}
+
+	gcc_pure
+	bool Match(unsigned i) const noexcept {
+		if (texts != nullptr) {
+			const auto &t = (*texts)[i];
+			return m.MatchFolded(t.data(), t.length());
+		}
+
+		char buffer[1024];
+		const char *label =
+			text.GetListItemText(buffer, sizeof(buffer), i);
+		assert(label != nullptr);
+
+		return m(label);
+	}
+
+	/**
+	 * Find the first matching item in the range [start, end).
+	 *
+	 * @return the item index or -1 if there is no match
+	 */
+	int FindFirst(unsigned start, unsigned end) const noexcept {
+		const unsigned n_threads = GetThreadCount(start, end);
+		if (n_threads == 1) {
+			for (unsigned i = start; i < end; ++i)
+				if (Match(i))
+					return i;
+			return -1;
+		}
+
+		/* the lowest slice which has found a match; slices
+		   after it can stop early */
+		std::atomic_uint found_slice(n_threads);
+		std::vector<int> results(n_threads, -1);
+
+		ParallelSlices(end - start, n_threads,
+			       [&, this](unsigned slice,
+					 size_t slice_start, size_t slice_end){
+				for (size_t i = start + slice_start;
+				     i < start + slice_end; ++i) {
+					if (found_slice.load(std::memory_order_relaxed) < slice)
+						/* an earlier slice has
+						   a match */
+						break;
+
+					if (Match(i)) {
+						results[slice] = i;
+						AtomicMin(found_slice, slice);
+						break;
+					}
+				}
+			});
+
+		for (const int i : results)
+			if (i >= 0)
+				return i;
+		return -1;
+	}
+
+	/**
+	 * Find the last matching item in the range [start, end).
+	 *
+	 * @return the item index or -1 if there is no match
+	 */
+	int FindLast(unsigned start, unsigned end) const noexcept {
+		const unsigned n_threads = GetThreadCount(start, end);
+		if (n_threads == 1) {
+			for (unsigned i = end; i > start; --i)
+				if (Match(i - 1))
+					return i - 1;
+			return -1;
+		}
+
+		/* the highest slice which has found a match (plus
+		   one); slices before it can stop early */
+		std::atomic_uint found_slice(0);
+		std::vector<int> results(n_threads, -1);
+
+		ParallelSlices(end - start, n_threads,
+			       [&, this](unsigned slice,
+					 size_t slice_start, size_t slice_end){
+				for (size_t i = start + slice_end;
+				     i > start + slice_start; --i) {
+					if (found_slice.load(std::memory_order_relaxed) > slice)
+						/* a later slice has a
+						   match */
+						break;
+
+					if (Match(i - 1)) {
+						results[slice] = i - 1;
+						AtomicMax(found_slice, slice + 1);
+						break;
+					}
+				}
+			});
+
+		for (auto i = results.rbegin(); i != results.rend(); ++i)
+			if (*i >= 0)
+				return *i;
+		return -1;
+	}
+
+private:
+	gcc_pure
+	unsigned GetThreadCount(unsigned start, unsigned end) const noexcept {
+		/* GetListItemText() is not thread-safe; only the
+		   cached texts can be searched in parallel */
+		return start < end && texts != nullptr
+			? CountThreads(end - start, PARALLEL_FIND_THRESHOLD)
+			: 1;
+	}
+
+	static void AtomicMin(std::atomic_uint &a, unsigned value) noexcept {
+		unsigned old = a.load();
+		while (value < old && !a.compare_exchange_weak(old, value)) {}
+	}
+
+	static void AtomicMax(std::atomic_uint &a, unsigned value) noexcept {
+		unsigned old = a.load();
+		while (value > old && !a.compare_exchange_weak(old, value)) {}
+	}
+};
+
+void
+ListWindow::PaintItems(const ListRenderer &renderer,
+		       const std::vector<unsigned> &items,
+		       size_t highlight) const noexcept
+{
+	for (unsigned i = 0; i < GetHeight(); i++) {
+		wmove(w, i, 0);
+
+		if (i >= items.size()) {
+			wclrtobot(w);
+			break;
+		}
+
+		assert(items[i] < GetLength());
+
+		renderer.PaintListItem(w, items[i], i, width,
+				       i == highlight);
+		++perf_stats.frame_rows_painted;
+	}
+
+	row_color_end(w);
+}
+
 bool
 ListWindow::Find(const ListText &text,
 		 const char *str,
 		 bool wrap,
 		 bool bell_on_wrap) noexcept
 {
-	unsigned i = GetCursorIndex() + 1;
-
 	assert(str != nullptr);
 
-	MatchExpression m;
-	if (!m.Compile(str, false))
+	const MatchExpression *m = GetMatchExpression(str, false);
+	if (m == nullptr)
 		return false;
 
-	do {
-		while (i < GetLength()) {
-			char buffer[1024];
-			const char *label =
-				text.GetListItemText(buffer, sizeof(buffer),
-						     i);
-			assert(label != nullptr);
-
-			if (m(label)) {
-				MoveCursor(i);
-				return true;
-			}
-			if (wrap && i == GetCursorIndex())
-				return false;
-			i++;
-		}
-		if (wrap) {
-			if (i == 0) /* empty list */
-				return 1;
-			i=0; /* first item */
-			if (bell_on_wrap) {
-				screen_bell();
-			}
-		}
-	} while (wrap);
+	const unsigned n = GetLength();
+	if (n == 0)
+		return wrap;
 
-	return false;
+	const unsigned cursor = GetCursorIndex();
+	const ListSearch search(text, n, *m);
+
+	int i = search.FindFirst(cursor + 1, n);
+	if (i < 0 && wrap) {
+		if (bell_on_wrap)
+			screen_bell();
+
+		/* continue at the first item, up to and including
+		   the cursor */
+		i = search.FindFirst(0, cursor + 1);
+	}
+
+	if (i < 0)
+		return false;
+
+	MoveCursor(i);
+	return true;
 }
 
 bool
@@ -113,42 +286,34 @@ ListWindow::ReverseFind(const ListText &text,
 			bool wrap,
 			bool bell_on_wrap) noexcept
 {
-	int i = GetCursorIndex() - 1;
-
 	assert(str != nullptr);
 
-	if (GetLength() == 0)
+	const unsigned n = GetLength();
+	if (n == 0)
 		return false;
 
-	MatchExpression m;
-	if (!m.Compile(str, false))
+	const MatchExpression *m = GetMatchExpression(str, false);
+	if (m == nullptr)
 		return false;
 
-	do {
-		while (i >= 0) {
-			char buffer[1024];
-			const char *label =
-				text.GetListItemText(buffer, sizeof(buffer),
-						     i);
-			assert(label != nullptr);
-
-			if (m(label)) {
-				MoveCursor(i);
-				return true;
-			}
-			if (wrap && i == (int)GetCursorIndex())
-				return false;
-			i--;
-		}
-		if (wrap) {
-			i = GetLength() - 1; /* last item */
-			if (bell_on_wrap) {
-				screen_bell();
-			}
-		}
-	} while (wrap);
+	const unsigned cursor = GetCursorIndex();
+	const ListSearch search(text, n, *m);
 
-	return false;
+	int i = search.FindLast(0, cursor);
+	if (i < 0 && wrap) {
+		if (bell_on_wrap)
+			screen_bell();
+
+		/* continue at the last item, down to and including
+		   the cursor */
+		i = search.FindLast(cursor, n);
+	}
+
+	if (i < 0)
+		return false;
+
+	MoveCursor(i);
+	return true;
 }
 
 bool
@@ -156,24 +321,18 @@ ListWindow::Jump(const ListText &text, const char *str) noexcept
 {
 	assert(str != nullptr);
 
-	MatchExpression m;
-	if (!m.Compile(str, options.jump_prefix_only))
+	const MatchExpression *m = GetMatchExpression(str,
+						      options.jump_prefix_only);
+	if (m == nullptr)
 		return false;
 
-	for (unsigned i = 0; i < GetLength(); i++) {
-		char buffer[1024];
-		const char *label =
-			text.GetListItemText(buffer, sizeof(buffer),
-					     i);
-		assert(label != nullptr);
-
-		if (m(label)) {
-			MoveCursor(i);
-			return true;
-		}
-	}
+	const unsigned n = GetLength();
+	const int i = ListSearch(text, n, *m).FindFirst(0, n);
+	if (i < 0)
+		return false;
 
-	return false;
+	MoveCursor(i);
+	return true;
 }
 
 /* perform basic list window commands (movement) */
@@ -24,6 +24,8 @@
 #include "Size.hxx"
 #include "config.h"
 
+#include <vector>
+
 #include <curses.h>
 
 enum class Command : unsigned;
@@ -54,6 +56,17 @@ public:
 
 	void Paint(const ListRenderer &renderer) const noexcept;
 
+	/**
+	 * Paint the given items instead of the list, e.g. the
+	 * results of a fuzzy find.
+	 *
+	 * @param highlight the position (in #items) of the item to be
+	 * highlighted
+	 */
+	void PaintItems(const ListRenderer &renderer,
+			const std::vector<unsigned> &items,
+			size_t highlight) const noexcept;
+
 	/** perform basic list window commands (movement) */
 	bool HandleCommand(Command cmd) noexcept;
 
@@ -0,0 +1,152 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_LRU_CACHE_HXX
+#define NCMPC_LRU_CACHE_HXX
+
+#include "util/Compiler.h"
+
+#include <list>
+#include <map>
+#include <utility>
+
+#include <assert.h>
+#include <stddef.h>
+
+/**
+ * A cache with a limited number of items; if it is full, the least
+ * recently used item is discarded.
+ */
+template<typename K, typename V>
+class LruCache {
+	using Item = std::pair<K, V>;
+	using List = std::list<Item>;
+
+	/**
+	 * All items, the most recently used one first.
+	 */
+	List items;
+
+	std::map<K, typename List::iterator> map;
+
+	const size_t max_size;
+
+	unsigned long hits = 0, misses = 0;
+
+public:
+	explicit LruCache(size_t _max_size) noexcept
+		:max_size(_max_size) {
+		assert(max_size > 0);
+	}
+
+	LruCache(const LruCache &) = delete;
+	LruCache &operator=(const LruCache &) = delete;
+
+	size_t size() const noexcept {
+		return items.size();
+	}
+
+	unsigned long GetHits() const noexcept {
+		return hits;
+	}
+
+	unsigned long GetMisses() const noexcept {
+		return misses;
+	}
+
+	void Clear() noexcept {
+		map.clear();
+		items.clear();
+	}
+
+	/**
+	 * Check whether the given key is in the cache, without marking
+	 * it as used and without updating the statistics.
+	 */
+	gcc_pure
+	bool Contains(const K &key) const noexcept {
+		return map.find(key) != map.end();
+	}
+
+	/**
+	 * Look up an item and mark it as recently used.
+	 *
+	 * @return the value or nullptr if there is no such item
+	 */
+	V *Find(const K &key) noexcept {
+		auto i = map.find(key);
+		if (i == map.end()) {
+			++misses;
+			return nullptr;
+		}
+
+		++hits;
+		items.splice(items.begin(), items, i->second);
+		return &i->second->second;
+	}
+
+	/**
+	 * Look up an item and remove it from the cache.
+	 *
+	 * @return true if the item was found and moved to #value
+	 */
+	bool Take(const K &key, V &value) noexcept {
+		auto i = map.find(key);
+		if (i == map.end()) {
+			++misses;
+			return false;
+		}
+
+		++hits;
+		value = std::move(i->second->second);
+		items.erase(i->second);
+		map.erase(i);
+		return true;
+	}
+
+	/**
+	 * Add an item (or replace an existing one with the same key).
+	 */
+	V &Put(K &&key, V &&value) {
+		auto i = map.find(key);
+		if (i != map.end()) {
+			items.splice(items.begin(), items, i->second);
+			return i->second->second = std::move(value);
+		}
+
+		if (items.size() >= max_size) {
+			map.erase(items.back().first);
+			items.pop_back();
+		}
+
+		items.emplace_front(std::move(key), std::move(value));
+		map.emplace(items.front().first, items.begin());
+		return items.front().second;
+	}
+
+	void Erase(const K &key) noexcept {
+		auto i = map.find(key);
+		if (i != map.end()) {
+			items.erase(i->second);
+			map.erase(i);
+		}
+	}
+};
+
+#endif
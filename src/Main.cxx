@@ -117,7 +117,7 @@ Instance::UpdateClient() noexcept
 		update_xterm_title();
 #endif
 
-	screen_manager.Update(client, seek);
+	screen_manager.Update(client, seek, volume);
 	client.events = (enum mpd_idle)0;
 }
 
@@ -175,7 +175,8 @@ mpdclient_failed_callback()
 void
 mpdclient_lost_callback()
 {
-	screen->Update(*mpd, global_instance->GetSeek());
+	screen->Update(*mpd, global_instance->GetSeek(),
+		       global_instance->GetVolume());
 
 	global_instance->ScheduleReconnect(std::chrono::seconds(1));
 }
@@ -192,7 +193,8 @@ mpdclient_idle_callback(gcc_unused unsigned events)
 		update_xterm_title();
 #endif
 
-	screen->Update(*mpd, global_instance->GetSeek());
+	screen->Update(*mpd, global_instance->GetSeek(),
+		       global_instance->GetVolume());
 	auto_update_timer();
 }
 
@@ -217,7 +219,8 @@ void begin_input_event()
 
 void end_input_event()
 {
-	screen->Update(*mpd, global_instance->GetSeek());
+	screen->Update(*mpd, global_instance->GetSeek(),
+		       global_instance->GetVolume());
 	mpd->events = (enum mpd_idle)0;
 
 	auto_update_timer();
@@ -231,11 +234,8 @@ do_input_event(boost::asio::io_service &io_service, Command cmd)
 		return false;
 	}
 
-	screen->OnCommand(*mpd, global_instance->GetSeek(), cmd);
-
-	if (cmd == Command::VOLUME_UP || cmd == Command::VOLUME_DOWN)
-		/* make sure we don't update the volume yet */
-		global_instance->DisableUpdateTimer();
+	screen->OnCommand(*mpd, global_instance->GetSeek(),
+			  global_instance->GetVolume(), cmd);
 
 	return true;
 }
@@ -245,7 +245,8 @@ do_input_event(boost::asio::io_service &io_service, Command cmd)
 void
 do_mouse_event(Point p, mmask_t bstate)
 {
-	screen->OnMouse(*mpd, global_instance->GetSeek(), p, bstate);
+	screen->OnMouse(*mpd, global_instance->GetSeek(),
+			global_instance->GetVolume(), p, bstate);
 }
 
 #endif
@@ -18,14 +18,101 @@
  */
 
 #include "Match.hxx"
+#include "LruCache.hxx"
+
+#include "FoldCase.hxx"
+
+#include <memory>
+#include <string>
+#include <utility>
 
 #include <assert.h>
 #include <string.h>
 
+/**
+ * The number of compiled expressions kept by GetMatchExpression().
+ */
+static constexpr size_t MATCH_CACHE_SIZE = 8;
+
+#ifdef HAVE_PCRE
+
+/**
+ * A pcre2_match_data object for the current thread.  Because all
+ * patterns are compiled with PCRE2_NO_AUTO_CAPTURE, only the
+ * overall match is needed, and one object can be used for all
+ * expressions.
+ */
+class MatchData {
+	pcre2_match_data *const data;
+
+public:
+	MatchData() noexcept
+		:data(pcre2_match_data_create(1, nullptr)) {}
+
+	~MatchData() noexcept {
+		pcre2_match_data_free(data);
+	}
+
+	MatchData(const MatchData &) = delete;
+	MatchData &operator=(const MatchData &) = delete;
+
+	pcre2_match_data *get() const noexcept {
+		return data;
+	}
+};
+
+static thread_local MatchData match_data;
+
+/**
+ * Fold a regular expression with FoldCase(), except for escape
+ * sequences (e.g. "\D" or "\p{Lu}"), whose meaning depends on the
+ * case.
+ */
+static std::string
+FoldPattern(const char *src) noexcept
+{
+	std::string result, run;
+
+	while (*src != 0) {
+		if (*src != '\\') {
+			run.push_back(*src++);
+			continue;
+		}
+
+		result += FoldCase(run.c_str());
+		run.clear();
+
+		/* copy the backslash and the escaped character */
+		result.push_back(*src++);
+		if (*src == 0)
+			break;
+
+		const bool braces = src[1] == '{';
+		result.push_back(*src++);
+
+		if (braces) {
+			/* e.g. "\x{e9}" or "\p{Lu}" */
+			const char *end = strchr(src, '}');
+			if (end == nullptr)
+				end = src + strlen(src);
+			else
+				++end;
+
+			result.append(src, end);
+			src = end;
+		}
+	}
+
+	result += FoldCase(run.c_str());
+	return result;
+}
+
+#endif
+
 MatchExpression::~MatchExpression() noexcept
 {
 #ifdef HAVE_PCRE
-	pcre_free(re);
+	pcre2_code_free(re);
 #endif
 }
 
@@ -33,38 +120,82 @@ bool
 MatchExpression::Compile(const char *src, bool anchor) noexcept
 {
 #ifndef HAVE_PCRE
-	expression = src;
-	length = strlen(expression);
+	expression = FoldCase(src);
 	anchored = anchor;
 
 	return true;
 #else
 	assert(re == nullptr);
 
-	int options = PCRE_CASELESS|PCRE_DOTALL|PCRE_NO_AUTO_CAPTURE;
+	/* fold like the literal matcher and IncrementalJump; the
+	   caseless flag covers letters which FoldCase() doesn't know
+	   about */
+	uint32_t options = PCRE2_CASELESS|PCRE2_DOTALL|PCRE2_NO_AUTO_CAPTURE;
 	if (anchor)
-		options |= PCRE_ANCHORED;
+		options |= PCRE2_ANCHORED;
 
-	const char *error_string;
-	int error_offset;
-	re = pcre_compile(src, options, &error_string, &error_offset, nullptr);
-	return re != nullptr;
+	const auto folded = FoldPattern(src);
+
+	int error_number;
+	PCRE2_SIZE error_offset;
+	re = pcre2_compile((PCRE2_SPTR)folded.data(), folded.length(), options,
+			   &error_number, &error_offset, nullptr);
+	if (re == nullptr)
+		return false;
+
+	/* if the JIT compiler is not available (or fails), the
+	   interpreter is used */
+	jit = pcre2_jit_compile(re, PCRE2_JIT_COMPLETE) == 0;
+	return true;
 #endif
 }
 
 bool
 MatchExpression::operator()(const char *line) const noexcept
 {
-#ifndef HAVE_PCRE
-	assert(expression != nullptr);
+	const auto folded = FoldCase(line);
+	return MatchFolded(folded.data(), folded.length());
+}
 
+bool
+MatchExpression::MatchFolded(const char *line, size_t length) const noexcept
+{
+#ifndef HAVE_PCRE
 	return anchored
-		? strncasecmp(line, expression, length) == 0
-		: strstr(line, expression) != nullptr;
+		? (length >= expression.length() &&
+		   memcmp(line, expression.data(), expression.length()) == 0)
+		: FindFolded(line, length, expression) != nullptr;
 #else
 	assert(re != nullptr);
 
-	return pcre_exec(re, nullptr, line, strlen(line),
-			 0, 0, nullptr, 0) >= 0;
+	pcre2_match_data *md = match_data.get();
+	if (md == nullptr)
+		/* out of memory */
+		return false;
+
+	const int n = jit
+		? pcre2_jit_match(re, (PCRE2_SPTR)line, length, 0, 0,
+				  md, nullptr)
+		: pcre2_match(re, (PCRE2_SPTR)line, length, 0, 0,
+			      md, nullptr);
+	return n >= 0;
 #endif
 }
+
+const MatchExpression *
+GetMatchExpression(const char *src, bool anchor) noexcept
+{
+	static LruCache<std::pair<std::string, bool>,
+			std::unique_ptr<MatchExpression>> cache(MATCH_CACHE_SIZE);
+
+	auto key = std::make_pair(std::string(src), anchor);
+	const auto *cached = cache.Find(key);
+	if (cached != nullptr)
+		return cached->get();
+
+	auto m = std::make_unique<MatchExpression>();
+	if (!m->Compile(src, anchor))
+		return nullptr;
+
+	return cache.Put(std::move(key), std::move(m)).get();
+}
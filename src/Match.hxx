@@ -24,18 +24,36 @@
 #include "util/Compiler.h"
 
 #ifdef HAVE_PCRE
-#include <pcre.h>
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
 #else
-#include <stddef.h>
+#include <string>
 #endif
 
+#include <stddef.h>
+
+/**
+ * Matches lines against a search pattern.  Both are folded with
+ * FoldCase(), so matching is caseless and accent-insensitive, with
+ * or without PCRE; in regular expressions, escape sequences are not
+ * folded.
+ */
 class MatchExpression {
 #ifndef HAVE_PCRE
-	const char *expression;
-	size_t length;
+	/**
+	 * The literal search string, converted with FoldCase().
+	 */
+	std::string expression;
+
 	bool anchored;
 #else
-	pcre *re = nullptr;
+	pcre2_code *re = nullptr;
+
+	/**
+	 * Has the pattern been compiled to machine code?  Then
+	 * pcre2_jit_match() can be used.
+	 */
+	bool jit = false;
 #endif
 
 public:
@@ -49,6 +67,27 @@ public:
 
 	gcc_pure
 	bool operator()(const char *line) const noexcept;
+
+	/**
+	 * Like operator(), but the line has already been converted
+	 * with FoldCase().  This is faster when the same lines are
+	 * matched repeatedly.
+	 */
+	gcc_pure
+	bool MatchFolded(const char *line, size_t length) const noexcept;
 };
 
+/**
+ * Return a compiled expression for the given pattern.  A few
+ * recently used expressions are cached, so repeated searches (e.g.
+ * "find next") don't compile the pattern again.  This function is
+ * not thread-safe, but the returned expression may be used in
+ * several threads.
+ *
+ * @return the expression (valid until the next call) or nullptr if
+ * the pattern is malformed
+ */
+const MatchExpression *
+GetMatchExpression(const char *src, bool anchor) noexcept;
+
 #endif
@@ -195,6 +195,9 @@ handle_option(int c, const char *arg)
 #ifdef ENABLE_OUTPUTS_SCREEN
 		     " outputs-screen"
 #endif
+#ifdef ENABLE_PERF_SCREEN
+		     " perf-screen"
+#endif
 #ifdef ENABLE_CHAT_SCREEN
 		     " chat-screen"
 #endif
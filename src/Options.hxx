@@ -54,6 +54,8 @@ struct Options {
 	std::vector<enum mpd_tag_type> library_page_tags{MPD_TAG_ARTIST, MPD_TAG_ALBUM};
 #endif
 
+	bool natural_sort = false;
+
 #ifdef ENABLE_LYRICS_SCREEN
 	std::chrono::steady_clock::duration lyrics_timeout = std::chrono::minutes(1);
 	bool lyrics_autosave = false;
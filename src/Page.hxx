@@ -72,6 +72,19 @@ public:
 		pending_events |= events;
 	}
 
+	bool HasPendingEvents(unsigned mask) const noexcept {
+		return (pending_events & mask) != 0;
+	}
+
+	/**
+	 * Remove the given events from the mask and keep them
+	 * pending for the next Update() call.
+	 */
+	void PostponeEvents(unsigned &events, unsigned mask) noexcept {
+		pending_events |= events & mask;
+		events &= ~mask;
+	}
+
 	void Update(struct mpdclient &c) noexcept {
 		Update(c, std::exchange(pending_events, 0));
 	}
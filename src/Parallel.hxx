@@ -0,0 +1,82 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_PARALLEL_HXX
+#define NCMPC_PARALLEL_HXX
+
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+/**
+ * Determine how many threads shall be used to process a list with
+ * #n items.  Lists shorter than #threshold are processed in the
+ * calling thread.
+ */
+static inline unsigned
+CountThreads(size_t n, size_t threshold) noexcept
+{
+	constexpr unsigned MAX_THREADS = 8;
+
+	if (n < threshold)
+		return 1;
+
+	return std::max(1u, std::min(std::thread::hardware_concurrency(),
+				     MAX_THREADS));
+}
+
+/**
+ * Invoke the function for each of #n_threads equal slices of the
+ * range [0, n), each in its own thread.  Falls back to the calling
+ * thread if threads cannot be created.  The function gets the slice
+ * number and the slice boundaries.
+ */
+template<typename F>
+static void
+ParallelSlices(size_t n, unsigned n_threads, F &&f) noexcept
+{
+	if (n_threads <= 1) {
+		f(0, 0, n);
+		return;
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(n_threads);
+
+	size_t start = 0;
+	for (unsigned i = 0; i < n_threads; ++i) {
+		const size_t end = n * (i + 1) / n_threads;
+
+		try {
+			threads.emplace_back(f, i, start, end);
+		} catch (const std::system_error &) {
+			f(i, start, end);
+		}
+
+		start = end;
+	}
+
+	for (auto &t : threads)
+		t.join();
+}
+
+#endif
@@ -0,0 +1,142 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "PathTrie.hxx"
+
+#include <algorithm>
+
+#include <assert.h>
+
+std::vector<std::unique_ptr<PathTrie::Node>>::iterator
+PathTrie::Node::FindChild(char ch) noexcept
+{
+	return std::lower_bound(children.begin(), children.end(), ch,
+				[](const std::unique_ptr<Node> &child, char c){
+					return (unsigned char)child->label.front() <
+						(unsigned char)c;
+				});
+}
+
+std::vector<std::unique_ptr<PathTrie::Node>>::const_iterator
+PathTrie::Node::FindChild(char ch) const noexcept
+{
+	return const_cast<Node *>(this)->FindChild(ch);
+}
+
+bool
+PathTrie::Insert(const std::string &value) noexcept
+{
+	Node *node = &root;
+	size_t i = 0;
+
+	while (i < value.length()) {
+		auto c = node->FindChild(value[i]);
+		if (c == node->children.end() ||
+		    (*c)->label.front() != value[i]) {
+			/* no matching child: add the rest as a new
+			   leaf */
+			auto leaf = std::make_unique<Node>(value.substr(i));
+			leaf->terminal = true;
+			node->children.emplace(c, std::move(leaf));
+			++n;
+			return true;
+		}
+
+		Node &child = **c;
+		const auto m = std::mismatch(child.label.begin(),
+					     child.label.end(),
+					     std::next(value.begin(), i),
+					     value.end());
+		const size_t common = std::distance(child.label.begin(),
+						    m.first);
+
+		if (common < child.label.length()) {
+			/* split the edge: insert a new node for the
+			   common part */
+			auto middle = std::make_unique<Node>(child.label.substr(0, common));
+			child.label.erase(0, common);
+			middle->children.emplace_back(std::move(*c));
+			*c = std::move(middle);
+		}
+
+		node = c->get();
+		i += common;
+	}
+
+	if (node->terminal)
+		return false;
+
+	node->terminal = true;
+	++n;
+	return true;
+}
+
+void
+PathTrie::Collect(const Node &node, std::string &path, size_t prefix_length,
+		  std::vector<std::string> &result) noexcept
+{
+	const size_t slash = path.find('/', prefix_length);
+	if (slash != std::string::npos && slash + 1 < path.length())
+		/* this is inside a subdirectory */
+		return;
+
+	if (node.terminal)
+		result.push_back(path);
+
+	if (slash != std::string::npos)
+		/* don't descend into subdirectories */
+		return;
+
+	const size_t length = path.length();
+	for (const auto &child : node.children) {
+		path += child->label;
+		Collect(*child, path, prefix_length, result);
+		path.resize(length);
+	}
+}
+
+void
+PathTrie::FindPrefix(const std::string &prefix,
+		     std::vector<std::string> &result) const noexcept
+{
+	const Node *node = &root;
+	std::string path;
+
+	while (path.length() < prefix.length()) {
+		const size_t i = path.length();
+		auto c = node->FindChild(prefix[i]);
+		if (c == node->children.end() ||
+		    (*c)->label.front() != prefix[i])
+			return;
+
+		const Node &child = **c;
+		const size_t n_compare = std::min(child.label.length(),
+						  prefix.length() - i);
+		if (prefix.compare(i, n_compare, child.label, 0, n_compare) != 0)
+			return;
+
+		/* the prefix may end in the middle of this label */
+		path += child.label;
+		node = &child;
+	}
+
+	assert(path.compare(0, prefix.length(), prefix) == 0);
+
+	Collect(*node, path, prefix.length(), result);
+}
@@ -0,0 +1,115 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_PATH_TRIE_HXX
+#define NCMPC_PATH_TRIE_HXX
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+/**
+ * A compact radix trie of path names.  Each edge is labeled with a
+ * string, and each node has at most one child per first byte, so
+ * looking up a prefix takes time proportional to its length, not to
+ * the number of strings.
+ */
+class PathTrie {
+	struct Node {
+		/**
+		 * The label of the edge leading to this node.
+		 */
+		std::string label;
+
+		/**
+		 * The children, sorted by the first byte of their
+		 * labels.
+		 */
+		std::vector<std::unique_ptr<Node>> children;
+
+		/**
+		 * Does a string end at this node?
+		 */
+		bool terminal = false;
+
+		Node() = default;
+
+		template<typename L>
+		explicit Node(L &&_label) noexcept
+			:label(std::forward<L>(_label)) {}
+
+		/**
+		 * Find the child whose label begins with the given
+		 * byte.
+		 *
+		 * @return the position in #children, which may be
+		 * the insertion point if there is no such child
+		 */
+		std::vector<std::unique_ptr<Node>>::iterator
+		FindChild(char ch) noexcept;
+
+		std::vector<std::unique_ptr<Node>>::const_iterator
+		FindChild(char ch) const noexcept;
+	};
+
+	Node root;
+
+	size_t n = 0;
+
+public:
+	bool empty() const noexcept {
+		return n == 0;
+	}
+
+	size_t size() const noexcept {
+		return n;
+	}
+
+	void clear() noexcept {
+		root.children.clear();
+		root.terminal = false;
+		n = 0;
+	}
+
+	/**
+	 * Add a string.
+	 *
+	 * @return false if the string was already in the trie
+	 */
+	bool Insert(const std::string &value) noexcept;
+
+	/**
+	 * Collect all strings beginning with the given prefix, in
+	 * byte order.  Strings which continue after a slash
+	 * following the prefix are omitted (i.e. the contents of
+	 * subdirectories), unless the slash is their last byte.
+	 */
+	void FindPrefix(const std::string &prefix,
+			std::vector<std::string> &result) const noexcept;
+
+private:
+	static void Collect(const Node &node, std::string &path,
+			    size_t prefix_length,
+			    std::vector<std::string> &result) noexcept;
+};
+
+#endif
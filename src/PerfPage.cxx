@@ -0,0 +1,293 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "PerfPage.hxx"
+#include "PageMeta.hxx"
+#include "TextPage.hxx"
+#include "PerfStats.hxx"
+#include "screen.hxx"
+#include "Command.hxx"
+#include "i18n.h"
+#include "mpdclient.hxx"
+
+#ifdef ENABLE_LIBRARY_PAGE
+#include "LibraryCache.hxx"
+#endif
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <chrono>
+#include <functional>
+
+#include <inttypes.h>
+#include <stdio.h>
+
+/**
+ * How often the statistics are refreshed while the page is visible.
+ */
+static constexpr std::chrono::steady_clock::duration PERF_REFRESH_INTERVAL =
+	std::chrono::seconds(1);
+
+/**
+ * A diagnostic page which shows the #PerfStats and a few other
+ * internal counters.
+ */
+class PerfPage final : public TextPage {
+	boost::asio::steady_timer refresh_timer;
+
+	struct mpdclient *client = nullptr;
+
+	/**
+	 * The value of IdleStatistics::received and the time of the
+	 * previous refresh; used to calculate the idle event rate.
+	 */
+	unsigned long last_idle_received = 0;
+	std::chrono::steady_clock::time_point last_refresh;
+
+	/**
+	 * The idle events per second, as calculated by the most
+	 * recent refresh.
+	 */
+	double idle_rate = 0;
+
+public:
+	PerfPage(ScreenManager &_screen, WINDOW *w, Size size)
+		:TextPage(_screen, w, size),
+		 refresh_timer(_screen.get_io_service()) {
+		/* start recording now, and keep recording after this
+		   page has been closed: the point is to measure the
+		   other pages after switching to them */
+		perf_stats.enabled = true;
+	}
+
+	~PerfPage() noexcept override {
+		refresh_timer.cancel();
+	}
+
+private:
+	void ScheduleRefresh() noexcept;
+	void OnRefreshTimer(const boost::system::error_code &error) noexcept;
+
+	void UpdateIdleRate(const struct mpdclient &c) noexcept;
+
+	void AppendHistogram(const char *name,
+			     const Histogram &h) noexcept;
+
+	/**
+	 * Regenerate all lines, without resetting the scroll
+	 * position.  This is only done by the refresh timer and by
+	 * SCREEN_UPDATE, not on every screen update, so this page
+	 * doesn't inflate the paint statistics it shows.
+	 */
+	void Reload(const struct mpdclient &c) noexcept;
+
+public:
+	/* virtual methods from class Page */
+	void OnOpen(struct mpdclient &c) noexcept override;
+	void OnClose() noexcept override;
+	bool OnCommand(struct mpdclient &c, Command cmd) override;
+	const char *GetTitle(char *s, size_t size) const noexcept override;
+};
+
+/**
+ * Format a duration [us] for humans.
+ */
+static const char *
+FormatMicroseconds(char *buffer, size_t size, unsigned us) noexcept
+{
+	if (us < 10000)
+		snprintf(buffer, size, "%u us", us);
+	else
+		snprintf(buffer, size, "%u ms", us / 1000);
+	return buffer;
+}
+
+void
+PerfPage::AppendHistogram(const char *name, const Histogram &h) noexcept
+{
+	char p50[32], p99[32], max[32], line[256];
+	snprintf(line, sizeof(line), "  %-12s %8" PRIu64 " %10s %10s %10s",
+		 name, h.GetCount(),
+		 FormatMicroseconds(p50, sizeof(p50), h.GetPercentile(50)),
+		 FormatMicroseconds(p99, sizeof(p99), h.GetPercentile(99)),
+		 FormatMicroseconds(max, sizeof(max), h.GetMax()));
+	lines.emplace_back(line);
+}
+
+void
+PerfPage::UpdateIdleRate(const struct mpdclient &c) noexcept
+{
+	const auto now = std::chrono::steady_clock::now();
+	const unsigned long received = c.idle_statistics.received;
+
+	if (last_refresh != std::chrono::steady_clock::time_point() &&
+	    received >= last_idle_received) {
+		const std::chrono::duration<double> elapsed = now - last_refresh;
+		if (elapsed.count() > 0)
+			idle_rate = (received - last_idle_received) / elapsed.count();
+	}
+
+	last_idle_received = received;
+	last_refresh = now;
+}
+
+void
+PerfPage::Reload(const struct mpdclient &c) noexcept
+{
+	lines.clear();
+
+	char line[256];
+	snprintf(line, sizeof(line), "%-14s %8s %10s %10s %10s",
+		 _("Round trip"), _("Count"), "p50", "p99", _("Max"));
+	lines.emplace_back(line);
+	AppendHistogram("status", perf_stats.status_latency);
+	AppendHistogram("queue", perf_stats.queue_latency);
+	AppendHistogram(_("other"), perf_stats.command_latency);
+
+	lines.emplace_back();
+	snprintf(line, sizeof(line), "%-14s %8s %10s %10s %10s",
+		 _("Screen"), _("Count"), "p50", "p99", _("Max"));
+	lines.emplace_back(line);
+	AppendHistogram(_("paint"), perf_stats.paint_duration);
+	AppendHistogram(_("input"), perf_stats.input_latency);
+
+	const uint64_t frames = perf_stats.frames;
+	snprintf(line, sizeof(line), "  %s: %u (%s %" PRIu64 ")",
+		 _("Rows repainted in the last frame"),
+		 perf_stats.frame_rows_painted,
+		 _("average"),
+		 frames > 0 ? perf_stats.rows_painted / frames : 0);
+	lines.emplace_back(line);
+
+	lines.emplace_back();
+	snprintf(line, sizeof(line), "%s: %.1f/s (%s %lu, %s %lu)",
+		 _("Idle events"), idle_rate,
+		 _("total"), c.idle_statistics.received,
+		 _("coalesced"), c.idle_statistics.coalesced);
+	lines.emplace_back(line);
+
+	snprintf(line, sizeof(line), "%s: %" PRIu64,
+		 _("Entities received"), perf_stats.entities_received);
+	lines.emplace_back(line);
+
+	snprintf(line, sizeof(line), "%s: %u",
+		 _("Queue length"), unsigned(c.playlist.size()));
+	lines.emplace_back(line);
+
+	snprintf(line, sizeof(line), "%s: %lu",
+		 _("File list entries"), perf_stats.file_list_entries);
+	lines.emplace_back(line);
+
+#ifdef ENABLE_LIBRARY_PAGE
+	if (perf_stats.library_cache != nullptr) {
+		const auto &cache = *perf_stats.library_cache;
+		const unsigned long hits = cache.values.GetHits() +
+			cache.songs.GetHits();
+		const unsigned long lookups = hits +
+			cache.values.GetMisses() + cache.songs.GetMisses();
+
+		snprintf(line, sizeof(line), "%s: %lu/%lu (%u%%)",
+			 _("Library cache hits"), hits, lookups,
+			 lookups > 0 ? unsigned(hits * 100 / lookups) : 0);
+		lines.emplace_back(line);
+	}
+#endif
+
+	lw.SetLength(lines.size());
+	SetDirty();
+}
+
+void
+PerfPage::ScheduleRefresh() noexcept
+{
+	boost::system::error_code error;
+	refresh_timer.expires_from_now(PERF_REFRESH_INTERVAL, error);
+	refresh_timer.async_wait(std::bind(&PerfPage::OnRefreshTimer,
+					   this, std::placeholders::_1));
+}
+
+void
+PerfPage::OnRefreshTimer(const boost::system::error_code &error) noexcept
+{
+	if (error || client == nullptr)
+		return;
+
+	UpdateIdleRate(*client);
+	Reload(*client);
+
+	if (screen.IsVisible(*this))
+		Repaint();
+
+	ScheduleRefresh();
+}
+
+static std::unique_ptr<Page>
+perf_init(ScreenManager &screen, WINDOW *w, Size size)
+{
+	return std::make_unique<PerfPage>(screen, w, size);
+}
+
+void
+PerfPage::OnOpen(struct mpdclient &c) noexcept
+{
+	client = &c;
+
+	UpdateIdleRate(c);
+	Reload(c);
+	ScheduleRefresh();
+}
+
+void
+PerfPage::OnClose() noexcept
+{
+	refresh_timer.cancel();
+	client = nullptr;
+}
+
+bool
+PerfPage::OnCommand(struct mpdclient &c, Command cmd)
+{
+	if (TextPage::OnCommand(c, cmd))
+		return true;
+
+	switch (cmd) {
+	case Command::SCREEN_UPDATE:
+		perf_stats.Clear();
+		Reload(c);
+		return true;
+
+	default:
+		break;
+	}
+
+	return false;
+}
+
+const char *
+PerfPage::GetTitle(char *, size_t) const noexcept
+{
+	return _("Performance");
+}
+
+const PageMeta screen_perf = {
+	"perf",
+	N_("Performance"),
+	Command::SCREEN_PERF,
+	perf_init,
+};
@@ -0,0 +1,36 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "PerfStats.hxx"
+
+PerfStats perf_stats;
+
+void
+PerfStats::Clear() noexcept
+{
+	input_latency.Clear();
+	status_latency.Clear();
+	queue_latency.Clear();
+	command_latency.Clear();
+	paint_duration.Clear();
+	frames = 0;
+	rows_painted = 0;
+	frame_rows_painted = 0;
+	entities_received = 0;
+}
@@ -0,0 +1,111 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_PERF_STATS_HXX
+#define NCMPC_PERF_STATS_HXX
+
+#include "Histogram.hxx"
+
+#include <stdint.h>
+
+struct LibraryCache;
+
+/**
+ * Timing counters which help diagnosing slow clients.
+ */
+struct PerfStats {
+	/**
+	 * Shall the (more expensive) timings below be recorded?  This
+	 * is enabled when the performance page is opened for the
+	 * first time; until then, the hooks only check this flag.
+	 *
+	 * It stays enabled on purpose when the page is closed, so
+	 * the other pages can be measured; this costs two clock
+	 * reads per MPD command and per frame.
+	 */
+	bool enabled = false;
+
+	/**
+	 * The time from the arrival of user input until the screen
+	 * has been updated.
+	 */
+	Histogram input_latency;
+
+	/**
+	 * The round trip time of the "status" command sent by
+	 * mpdclient::Update().
+	 */
+	Histogram status_latency;
+
+	/**
+	 * The round trip time of the commands which reload the queue
+	 * ("playlistinfo" and "plchanges").
+	 */
+	Histogram queue_latency;
+
+	/**
+	 * The round trip time of all other commands completed with
+	 * mpdclient::FinishCommand().
+	 */
+	Histogram command_latency;
+
+	/**
+	 * The time needed by ScreenManager::Paint().
+	 */
+	Histogram paint_duration;
+
+	/**
+	 * The number of frames painted by ScreenManager::Paint().
+	 */
+	uint64_t frames = 0;
+
+	/**
+	 * The number of list rows painted in all frames, and in the
+	 * most recent one.
+	 */
+	uint64_t rows_painted = 0;
+	unsigned frame_rows_painted = 0;
+
+	/**
+	 * The number of entities (songs, directories, playlists)
+	 * received from MPD.
+	 */
+	uint64_t entities_received = 0;
+
+	/**
+	 * The number of entries in all #FileList instances.
+	 */
+	unsigned long file_list_entries = 0;
+
+	/**
+	 * The cache of the library page (if it exists); its hit rate
+	 * is shown on the performance page.
+	 */
+	const LibraryCache *library_cache = nullptr;
+
+	/**
+	 * Reset all statistics except for the gauges which describe
+	 * the current state (e.g. #file_list_entries).
+	 */
+	void Clear() noexcept;
+};
+
+extern PerfStats perf_stats;
+
+#endif
@@ -18,16 +18,83 @@
  */
 
 #include "Queue.hxx"
-
-#include <algorithm>
+#include "UriSet.hxx"
 
 #include <string.h>
 
+/**
+ * The maximum number of entries in MpdQueue::uri_log.  If there are
+ * more changes, it's cheaper to check all URIs.
+ */
+static constexpr size_t MAX_URI_LOG = 1024;
+
+/**
+ * The maximum number of entries in MpdQueue::edit_log.
+ */
+static constexpr size_t MAX_EDIT_LOG = 1024;
+
 void
 MpdQueue::clear()
 {
 	version = 0;
+	ResetEditLog();
 	items.clear();
+	uri_counts.clear();
+	ResetUriLog();
+}
+
+void
+MpdQueue::LogUri(const char *uri)
+{
+	if (uri_log.size() >= MAX_URI_LOG)
+		ResetUriLog();
+	else
+		uri_log.emplace_back(uri);
+}
+
+void
+MpdQueue::LogEdit(QueueEdit::Type type, unsigned a, unsigned b)
+{
+	if (edit_log.size() >= MAX_EDIT_LOG)
+		ResetEditLog();
+	else
+		edit_log.push_back({type, a, b});
+}
+
+void
+MpdQueue::AddUri(const struct mpd_song &song)
+{
+	const char *uri = mpd_song_get_uri(&song);
+	if (uri_counts[uri]++ == 0)
+		LogUri(uri);
+}
+
+void
+MpdQueue::RemoveUri(const struct mpd_song &song)
+{
+	const char *uri = mpd_song_get_uri(&song);
+	auto i = uri_counts.find(uri);
+	assert(i != uri_counts.end());
+	assert(i->second > 0);
+
+	if (--i->second == 0) {
+		uri_counts.erase(i);
+		LogUri(uri);
+	}
+}
+
+void
+MpdQueue::RemoveRange(size_type start, size_type end)
+{
+	assert(start <= end);
+	assert(end <= size());
+
+	LogEdit(QueueEdit::Type::REMOVE, start, end);
+
+	for (size_type i = start; i < end; ++i)
+		RemoveUri(*items[i]);
+
+	items.erase(start, end);
 }
 
 const struct mpd_song *
@@ -40,46 +107,88 @@ MpdQueue::GetChecked(int idx) const
 }
 
 void
-MpdQueue::Move(unsigned dest, unsigned src)
+MpdQueue::TakeRange(size_type start, size_type end, std::vector<Item> &dest)
 {
-	assert(src < size());
-	assert(dest < size());
-	assert(src != dest);
-
-	auto song = std::move(items[src]);
-
-	if (src < dest) {
-		std::move(std::next(items.begin(), src + 1),
-			  std::next(items.begin(), dest + 1),
-			  std::next(items.begin(), src));
-	} else {
-		std::move_backward(std::next(items.begin(), dest),
-				   std::next(items.begin(), src),
-				   std::next(items.begin(), src + 1));
+	assert(start <= end);
+	assert(end <= size());
+
+	LogEdit(QueueEdit::Type::REMOVE, start, end);
+
+	dest.reserve(dest.size() + end - start);
+	for (size_type i = start; i < end; ++i) {
+		RemoveUri(*items[i]);
+		dest.emplace_back(std::move(items[i]));
 	}
 
-	assert(!items[dest]);
-	items[dest] = std::move(song);
+	items.erase(start, end);
+}
+
+void
+MpdQueue::Reorder(size_type start, const std::vector<unsigned> &order)
+{
+	/* this doesn't change the set of URIs, so bypass
+	   TakeRange() and Insert() */
+	LogEdit(QueueEdit::Type::REORDER, start, start + order.size());
+
+	std::vector<Item> tmp;
+	tmp.reserve(order.size());
+	for (size_type i = start; i < start + order.size(); ++i)
+		tmp.emplace_back(std::move(items[i]));
+
+	items.erase(start, start + order.size());
+
+	for (const unsigned i : order) {
+		assert(i < tmp.size());
+		assert(tmp[i]);
+
+		items.insert(start++, std::move(tmp[i]));
+	}
 }
 
 MpdQueue::size_type
 MpdQueue::FindByReference(const struct mpd_song &song) const
 {
-	for (size_type i = 0;; ++i) {
-		assert(i < size());
-
-		if (&(*this)[i] == &song)
+	size_type i = 0;
+	for (const auto &item : items) {
+		if (item.get() == &song)
 			return i;
+		++i;
+	}
+
+	assert(false);
+	gcc_unreachable();
+}
+
+std::vector<unsigned>
+MpdQueue::FindDuplicates(int keep) const
+{
+	UriSet uris;
+	uris.reserve(size());
+
+	if (keep >= 0 && (size_type)keep < size())
+		uris.emplace(mpd_song_get_uri(&(*this)[keep]));
+
+	std::vector<unsigned> result;
+
+	unsigned i = 0;
+	for (const auto &song : items) {
+		if (int(i) != keep &&
+		    !uris.emplace(mpd_song_get_uri(song.get())).second)
+			result.push_back(i);
+		++i;
 	}
+
+	return result;
 }
 
 int
 MpdQueue::FindById(unsigned id) const
 {
-	for (size_type i = 0; i < size(); ++i) {
-		const auto &song = (*this)[i];
-		if (mpd_song_get_id(&song) == id)
+	int i = 0;
+	for (const auto &song : items) {
+		if (mpd_song_get_id(song.get()) == id)
 			return i;
+		++i;
 	}
 
 	return -1;
@@ -88,10 +197,11 @@ MpdQueue::FindById(unsigned id) const
 int
 MpdQueue::FindByUri(const char *filename) const
 {
-	for (size_type i = 0; i < size(); ++i) {
-		const auto &song = (*this)[i];
-		if (strcmp(mpd_song_get_uri(&song), filename) == 0)
+	int i = 0;
+	for (const auto &song : items) {
+		if (strcmp(mpd_song_get_uri(song.get()), filename) == 0)
 			return i;
+		++i;
 	}
 
 	return -1;
@@ -20,14 +20,19 @@
 #ifndef QUEUE_HXX
 #define QUEUE_HXX
 
+#include "ChunkedVector.hxx"
 #include "util/Compiler.h"
 
 #include <mpd/client.h>
 
-#include <vector>
+#include <iterator>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <assert.h>
+#include <stdint.h>
 
 struct SongDeleter {
 	void operator()(struct mpd_song *song) const {
@@ -35,13 +40,51 @@ struct SongDeleter {
 	}
 };
 
+/**
+ * One modification of the #MpdQueue; see MpdQueue::VisitEdits().
+ */
+struct QueueEdit {
+	enum class Type : uint8_t {
+		/**
+		 * A song was inserted at position #a.
+		 */
+		INSERT,
+
+		/**
+		 * The songs in the range [#a, #b) were removed.
+		 */
+		REMOVE,
+
+		/**
+		 * The song at position #a was replaced.
+		 */
+		REPLACE,
+
+		/**
+		 * The song at position #b was moved to position #a.
+		 */
+		MOVE,
+
+		/**
+		 * The songs in the range [#a, #b) were rearranged.
+		 */
+		REORDER,
+	} type;
+
+	unsigned a, b;
+};
+
 struct MpdQueue {
 	/* queue version number (obtained from mpd_status) */
 	unsigned version = 0;
 
-	using Vector = std::vector<std::unique_ptr<struct mpd_song, SongDeleter>>;
+	using Item = std::unique_ptr<struct mpd_song, SongDeleter>;
+	using Vector = ChunkedVector<Item>;
 
-	/* the list */
+	/**
+	 * The list.  Do not modify it directly; use the methods
+	 * below, which keep #uri_counts up to date.
+	 */
 	Vector items;
 
 	using size_type = Vector::size_type;
@@ -73,18 +116,58 @@ struct MpdQueue {
 	const struct mpd_song *GetChecked(int i) const;
 
 	void push_back(const struct mpd_song &song) {
+		LogEdit(QueueEdit::Type::INSERT, size());
+		AddUri(song);
 		items.emplace_back(mpd_song_dup(&song));
 	}
 
+	void Insert(size_type i, Item &&song) {
+		LogEdit(QueueEdit::Type::INSERT, i);
+		AddUri(*song);
+		items.insert(i, std::move(song));
+	}
+
 	void Replace(size_type i, const struct mpd_song &song) {
+		LogEdit(QueueEdit::Type::REPLACE, i);
+
+		/* add first, so the URI count doesn't drop to zero
+		   if the URI is the same */
+		AddUri(song);
+		RemoveUri(*items[i]);
 		items[i].reset(mpd_song_dup(&song));
 	}
 
 	void RemoveIndex(size_type i) {
-		items.erase(std::next(items.begin(), i));
+		LogEdit(QueueEdit::Type::REMOVE, i, i + 1);
+		RemoveUri(*items[i]);
+		items.erase(i);
 	}
 
-	void Move(unsigned dest, unsigned src);
+	/**
+	 * Remove all songs in the range [start, end).
+	 */
+	void RemoveRange(size_type start, size_type end);
+
+	/**
+	 * Like RemoveRange(), but move the removed songs to the end
+	 * of the given container instead of freeing them.
+	 */
+	void TakeRange(size_type start, size_type end,
+		       std::vector<Item> &dest);
+
+	/**
+	 * Rearrange the songs in the range [start,
+	 * start+order.size()): the song at relative position
+	 * order[i] is moved to relative position i.
+	 */
+	void Reorder(size_type start, const std::vector<unsigned> &order);
+
+	void Move(unsigned dest, unsigned src) {
+		assert(src != dest);
+
+		LogEdit(QueueEdit::Type::MOVE, dest, src);
+		items.Move(dest, src);
+	}
 
 	/**
 	 * Find a song by its reference.  This method compares
@@ -121,13 +204,130 @@ struct MpdQueue {
 	int FindIdByUri(const char *uri) const {
 		int i = FindByUri(uri);
 		if (i >= 0)
-			i = mpd_song_get_id(items[i].get());
+			i = mpd_song_get_id(&(*this)[i]);
 		return i;
 	}
 
 	gcc_pure
 	bool ContainsUri(const char *uri) const {
-		return FindByUri(uri) >= 0;
+		return uri_counts.find(uri) != uri_counts.end();
+	}
+
+	/**
+	 * Returns a number which changes whenever songs are added,
+	 * removed, replaced or moved.  It allows callers to cache
+	 * data derived from the whole list, and to pass it to
+	 * VisitEdits() later.
+	 */
+	gcc_pure
+	unsigned long GetEditSerial() const {
+		return edit_log_start + edit_log.size();
+	}
+
+	/**
+	 * Invoke the given function for each #QueueEdit since
+	 * GetEditSerial() returned the given value, in the order they
+	 * were applied.
+	 *
+	 * @return false if the edits are not known anymore (the
+	 * caller must then rebuild its data from the whole list)
+	 */
+	template<typename F>
+	bool VisitEdits(unsigned long serial, F &&f) const {
+		if (serial < edit_log_start || serial > GetEditSerial())
+			return false;
+
+		for (auto i = std::next(edit_log.begin(),
+					serial - edit_log_start);
+		     i != edit_log.end(); ++i)
+			f(*i);
+
+		return true;
+	}
+
+	/**
+	 * Returns a number which identifies the current state of the
+	 * set of URIs in the queue; pass it to VisitUriChanges()
+	 * later.
+	 */
+	gcc_pure
+	unsigned long GetUriSerial() const {
+		return uri_log_start + uri_log.size();
+	}
+
+	/**
+	 * Invoke the given function for each URI which has been
+	 * added to or removed from the queue since GetUriSerial()
+	 * returned the given value.  A URI may be visited more than
+	 * once; use ContainsUri() to check its current state.
+	 *
+	 * @return false if the changes are not known anymore (the
+	 * caller must then check all of its URIs)
+	 */
+	template<typename F>
+	bool VisitUriChanges(unsigned long serial, F &&f) const {
+		if (serial < uri_log_start || serial > GetUriSerial())
+			return false;
+
+		for (auto i = std::next(uri_log.begin(),
+					serial - uri_log_start);
+		     i != uri_log.end(); ++i)
+			f(*i);
+
+		return true;
+	}
+
+	/**
+	 * Find all songs whose URI occurs earlier in the queue.
+	 *
+	 * @param keep the position of a song which shall be kept
+	 * even if it is a duplicate (e.g. the song being played); -1
+	 * for none; earlier occurrences of this song are reported
+	 * instead
+	 * @return the positions of the duplicates in ascending order
+	 */
+	gcc_pure
+	std::vector<unsigned> FindDuplicates(int keep) const;
+
+private:
+	/**
+	 * Modifications of #items.  The first element has the serial
+	 * #edit_log_start; see VisitEdits().
+	 */
+	std::vector<QueueEdit> edit_log;
+	unsigned long edit_log_start = 0;
+
+	/**
+	 * The number of occurrences of each URI in the queue.
+	 */
+	std::unordered_map<std::string, unsigned> uri_counts;
+
+	/**
+	 * URIs which have been added to or removed from the queue
+	 * (i.e. whose count has changed from or to zero).  The first
+	 * element has the serial #uri_log_start; see
+	 * VisitUriChanges().
+	 */
+	std::vector<std::string> uri_log;
+	unsigned long uri_log_start = 0;
+
+	void AddUri(const struct mpd_song &song);
+	void RemoveUri(const struct mpd_song &song);
+	void LogUri(const char *uri);
+	void LogEdit(QueueEdit::Type type, unsigned a, unsigned b=0);
+
+	/**
+	 * Forget all logged changes; all previously obtained serials
+	 * become invalid.
+	 */
+	void ResetUriLog() noexcept {
+		uri_log_start += uri_log.size() + 1;
+		uri_log.clear();
+	}
+
+	void ResetEditLog() noexcept {
+		edit_log_start += edit_log.size() + 1;
+		edit_log.clear();
 	}
 };
 
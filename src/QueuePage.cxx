@@ -22,10 +22,14 @@
 #include "ListPage.hxx"
 #include "ListRenderer.hxx"
 #include "ListText.hxx"
+#include "ListTextCache.hxx"
+#include "ListFilter.hxx"
 #include "FileBrowserPage.hxx"
 #include "screen_status.hxx"
 #include "screen_find.hxx"
 #include "save_playlist.hxx"
+#include "QueueSort.hxx"
+#include "Match.hxx"
 #include "config.h"
 #include "i18n.h"
 #include "charset.hxx"
@@ -52,7 +56,6 @@
 
 #include <boost/asio/steady_timer.hpp>
 
-#include <set>
 #include <string>
 
 #include <string.h>
@@ -69,12 +72,37 @@ class QueuePage final : public ListPage, ListRenderer, ListText {
 	boost::asio::steady_timer hide_cursor_timer;
 
 	MpdQueue *playlist = nullptr;
+
+	/**
+	 * The formatted songs, for searching the queue.
+	 */
+	mutable ListTextCache text_cache;
+
+	/**
+	 * The MpdQueue::GetEditSerial() value of the #text_cache
+	 * contents.
+	 */
+	mutable unsigned long text_cache_serial = 0;
+
+	/**
+	 * Shows only the songs matching a pattern.
+	 */
+	ListFilter filter;
+
+	/**
+	 * The MpdQueue::GetEditSerial() value which #filter is
+	 * up to date with.
+	 */
+	unsigned long filter_serial = 0;
+
 	int current_song_id = -1;
 	int selected_song_id = -1;
 
 	unsigned last_connection_id = 0;
 	std::string connection_name;
 
+	History sort_history;
+
 	bool playing = false;
 
 public:
@@ -97,6 +125,46 @@ private:
 	void SaveSelection();
 	void RestoreSelection();
 
+	void UpdateLength() {
+		lw.SetLength(filter.GetRowCount(playlist->size()));
+	}
+
+	/**
+	 * Format the song at the given queue position with the
+	 * list format.
+	 */
+	const char *FormatSong(char *buffer, size_t size,
+			       unsigned position) const noexcept;
+
+	/**
+	 * Does the song at the given queue position match the
+	 * filter pattern?
+	 */
+	gcc_pure
+	bool MatchFilter(const MatchExpression &expression,
+			 unsigned position) const noexcept;
+
+	/**
+	 * Apply the queue modifications since the last call to
+	 * #filter, matching only the inserted and replaced songs.
+	 */
+	void SyncFilter() noexcept;
+
+	/**
+	 * Ask the user for a new filter pattern.
+	 */
+	void EditFilter() noexcept;
+
+	/**
+	 * Convert a row range to a range of queue positions.
+	 *
+	 * @return false if the rows are not contiguous in the queue
+	 * (because songs in between are filtered out)
+	 */
+	gcc_pure
+	bool GetPositionRange(ListWindowRange range,
+			      unsigned &start, unsigned &end) const noexcept;
+
 	void Repaint() const {
 		Paint();
 		lw.Refresh();
@@ -105,6 +173,12 @@ private:
 	void CenterPlayingItem(const struct mpd_status *status,
 			       bool center_cursor);
 
+	/**
+	 * Ask the user for a sort specification and sort the queue
+	 * (or the selected range).
+	 */
+	void SortQueue(struct mpdclient &c);
+
 	bool OnSongChange(const struct mpd_status *status);
 
 	void OnHideCursorTimer(const boost::system::error_code &error) noexcept;
@@ -127,6 +201,9 @@ private:
 	/* virtual methods from class ListText */
 	const char *GetListItemText(char *buffer, size_t size,
 				    unsigned i) const noexcept override;
+	const std::vector<std::string> *
+	GetCachedListItemTexts(unsigned length,
+			       bool folded) const noexcept override;
 
 public:
 	/* virtual methods from class Page */
@@ -148,7 +225,7 @@ const struct mpd_song *
 QueuePage::GetSelectedSong() const
 {
 	return lw.IsSingleCursor()
-		? &(*playlist)[lw.GetCursorIndex()]
+		? &(*playlist)[filter.ToPosition(lw.GetCursorIndex())]
 		: nullptr;
 }
 
@@ -163,7 +240,7 @@ QueuePage::SaveSelection()
 void
 QueuePage::RestoreSelection()
 {
-	lw.SetLength(playlist->size());
+	UpdateLength();
 
 	if (selected_song_id < 0)
 		/* there was no selection */
@@ -176,6 +253,8 @@ QueuePage::RestoreSelection()
 		return;
 
 	int pos = playlist->FindById(selected_song_id);
+	if (pos >= 0)
+		pos = filter.ToRow(pos);
 	if (pos >= 0)
 		lw.SetCursor(pos);
 
@@ -183,17 +262,149 @@ QueuePage::RestoreSelection()
 }
 
 const char *
-QueuePage::GetListItemText(char *buffer, size_t size,
-			   unsigned idx) const noexcept
+QueuePage::FormatSong(char *buffer, size_t size,
+		      unsigned position) const noexcept
 {
-	assert(idx < playlist->size());
+	assert(position < playlist->size());
 
-	const auto &song = (*playlist)[idx];
+	const auto &song = (*playlist)[position];
 	strfsong(buffer, size, options.list_format.c_str(), &song);
 
 	return buffer;
 }
 
+const char *
+QueuePage::GetListItemText(char *buffer, size_t size,
+			   unsigned idx) const noexcept
+{
+	return FormatSong(buffer, size, filter.ToPosition(idx));
+}
+
+const std::vector<std::string> *
+QueuePage::GetCachedListItemTexts(unsigned length,
+				  bool folded) const noexcept
+{
+	if (filter.IsActive())
+		/* the cache is indexed by queue position, not by
+		   row */
+		return nullptr;
+
+	if (length != playlist->size())
+		/* not yet updated */
+		return nullptr;
+
+	if (playlist->GetEditSerial() != text_cache_serial) {
+		text_cache.Invalidate();
+		text_cache_serial = playlist->GetEditSerial();
+	}
+
+	return &text_cache.Get(*this, length, folded);
+}
+
+bool
+QueuePage::MatchFilter(const MatchExpression &expression,
+		       unsigned position) const noexcept
+{
+	char buffer[MAX_SONG_LENGTH];
+	return expression(FormatSong(buffer, sizeof(buffer), position));
+}
+
+void
+QueuePage::SyncFilter() noexcept
+{
+	const unsigned long serial = playlist->GetEditSerial();
+	if (serial == filter_serial)
+		return;
+
+	const unsigned long old_serial = filter_serial;
+	filter_serial = serial;
+
+	if (!filter.IsActive())
+		return;
+
+	const auto *expression =
+		GetMatchExpression(filter.GetPattern().c_str(), false);
+	assert(expression != nullptr);
+
+	const auto match = [this, expression](unsigned position){
+		return MatchFilter(*expression, position);
+	};
+
+	const bool replayed =
+		playlist->VisitEdits(old_serial, [this](const QueueEdit &edit){
+				switch (edit.type) {
+				case QueueEdit::Type::INSERT:
+					filter.OnInsert(edit.a);
+					break;
+
+				case QueueEdit::Type::REMOVE:
+					filter.OnRemove(edit.a, edit.b);
+					break;
+
+				case QueueEdit::Type::REPLACE:
+					filter.OnReplace(edit.a);
+					break;
+
+				case QueueEdit::Type::MOVE:
+					filter.OnMove(edit.a, edit.b);
+					break;
+
+				case QueueEdit::Type::REORDER:
+					filter.OnReorder(edit.a, edit.b);
+					break;
+				}
+			});
+
+	if (replayed)
+		filter.Commit(match);
+	else
+		filter.Refresh(playlist->size(), match);
+}
+
+void
+QueuePage::EditFilter() noexcept
+{
+	std::string pattern = filter.GetPattern();
+	if (!screen_read_filter(screen, pattern))
+		return;
+
+	/* keep the cursor on the selected song if it remains
+	   visible */
+	SaveSelection();
+
+	if (pattern.empty()) {
+		filter.Clear();
+	} else {
+		const auto *expression =
+			GetMatchExpression(pattern.c_str(), false);
+		assert(expression != nullptr);
+
+		filter.Set(std::move(pattern), playlist->size(),
+			   [this, expression](unsigned position){
+				   return MatchFilter(*expression, position);
+			   });
+	}
+
+	filter_serial = playlist->GetEditSerial();
+
+	UpdateLength();
+	lw.SetCursor(0);
+	RestoreSelection();
+	SetDirty();
+}
+
+bool
+QueuePage::GetPositionRange(ListWindowRange range,
+			    unsigned &start, unsigned &end) const noexcept
+{
+	if (range.empty())
+		return false;
+
+	start = filter.ToPosition(range.start_index);
+	end = filter.ToPosition(range.end_index - 1) + 1;
+	return end - start == range.end_index - range.start_index;
+}
+
 void
 QueuePage::CenterPlayingItem(const struct mpd_status *status,
 			     bool center_cursor)
@@ -205,6 +416,8 @@ QueuePage::CenterPlayingItem(const struct mpd_status *status,
 
 	/* try to center the song that are playing */
 	int idx = mpd_status_get_song_pos(status);
+	if (idx >= 0)
+		idx = filter.ToRow(idx);
 	if (idx < 0)
 		return;
 
@@ -246,55 +459,39 @@ QueuePage::OnSongChange(const struct mpd_status *status)
 }
 
 #ifndef NCMPC_MINI
-static void
-add_dir(Completion &completion, const char *dir,
-	struct mpdclient *c)
-{
-	completion.clear();
-	gcmp_list_from_path(c, dir, completion, GCMP_TYPE_RFILE);
-}
-
 class DatabaseCompletion final : public Completion {
 	struct mpdclient &c;
-	std::set<std::string> dir_list;
 
 public:
 	explicit DatabaseCompletion(struct mpdclient &_c) noexcept
-		:c(_c) {}
+		:Completion(GetDatabaseCompletionList(_c)), c(_c) {}
 
 protected:
 	/* virtual methods from class Completion */
 	void Pre(const char *value) noexcept override;
-	void Post(const char *value, Range range) noexcept override;
+	void Post(const char *value, const Range &range) noexcept override;
 };
 
 void
 DatabaseCompletion::Pre(const char *line) noexcept
 {
-	if (empty()) {
-		/* create initial list */
-		gcmp_list_from_path(&c, "", *this, GCMP_TYPE_RFILE);
-	} else if (line && line[0] && line[strlen(line) - 1] == '/') {
-		auto i = dir_list.emplace(line);
-		if (i.second)
-			/* add directory content to list */
-			add_dir(*this, line, &c);
-	}
+	/* the root directory (unless already loaded) */
+	LoadDatabaseCompletion(c, "");
+
+	if (line && line[0] && line[strlen(line) - 1] == '/')
+		/* add directory content to list */
+		LoadDatabaseCompletion(c, line);
 }
 
 void
-DatabaseCompletion::Post(const char *line, Range range) noexcept
+DatabaseCompletion::Post(const char *line, const Range &range) noexcept
 {
-	if (range.begin() != range.end() &&
-	    std::next(range.begin()) != range.end())
+	if (range.size() > 1)
 		screen_display_completion_list(range);
 
-	if (line && line[0] && line[strlen(line) - 1] == '/') {
+	if (line && line[0] && line[strlen(line) - 1] == '/')
 		/* add directory content to list */
-		auto i = dir_list.emplace(line);
-		if (i.second)
-			add_dir(*this, line, &c);
-	}
+		LoadDatabaseCompletion(c, line);
 }
 
 #endif
@@ -324,6 +521,46 @@ handle_add_to_playlist(struct mpdclient *c)
 	return 0;
 }
 
+void
+QueuePage::SortQueue(struct mpdclient &c)
+{
+	auto range = lw.GetRange();
+	if (range.end_index <= range.start_index + 1) {
+		if (filter.IsActive()) {
+			screen_status_message(_("Cannot sort a filtered queue"));
+			return;
+		}
+
+		/* no range selection, sort the whole queue */
+		range.start_index = 0;
+		range.end_index = playlist->size();
+	} else if (!GetPositionRange(range, range.start_index,
+				     range.end_index)) {
+		screen_status_message(_("Cannot sort a filtered queue"));
+		return;
+	}
+
+	/* the default is the list format, i.e. sort by what the
+	   user sees; alternatively, the user may enter a list of
+	   tag names */
+	const auto spec = screen_readln(_("Sort by (format or tags)"),
+					options.list_format.c_str(),
+					&sort_history, nullptr);
+	if (spec.empty())
+		return;
+
+	const auto order = SortQueueOrder(*playlist, range.start_index,
+					  range.end_index, spec.c_str());
+	if (order.empty() && range.end_index > range.start_index) {
+		screen_status_printf(_("Invalid sort order: %s"),
+				     spec.c_str());
+		return;
+	}
+
+	if (c.RunReorder(range.start_index, order))
+		screen_status_message(_("Sorted queue"));
+}
+
 static std::unique_ptr<Page>
 screen_queue_init(ScreenManager &_screen, WINDOW *w, Size size)
 {
@@ -357,6 +594,7 @@ QueuePage::OnOpen(struct mpdclient &c) noexcept
 		ScheduleHideCursor();
 	}
 
+	SyncFilter();
 	RestoreSelection();
 	OnSongChange(c.status);
 }
@@ -375,6 +613,17 @@ QueuePage::OnClose() noexcept
 const char *
 QueuePage::GetTitle(char *str, size_t size) const noexcept
 {
+	if (filter.IsActive()) {
+		if (connection_name.empty())
+			snprintf(str, size, _("Queue [%s]"),
+				 filter.GetPattern().c_str());
+		else
+			snprintf(str, size, _("Queue on %s [%s]"),
+				 connection_name.c_str(),
+				 filter.GetPattern().c_str());
+		return str;
+	}
+
 	if (connection_name.empty())
 		return _("Queue");
 
@@ -387,8 +636,7 @@ QueuePage::PaintListItem(WINDOW *w, unsigned i, unsigned y, unsigned width,
 			 bool selected) const noexcept
 {
 	assert(playlist != nullptr);
-	assert(i < playlist->size());
-	const auto &song = (*playlist)[i];
+	const auto &song = (*playlist)[filter.ToPosition(i)];
 
 	class hscroll *row_hscroll = nullptr;
 #ifndef NCMPC_MINI
@@ -427,8 +675,7 @@ QueuePage::PaintStatusBarOverride(const Window &window) const noexcept
 
 	assert(playlist != nullptr);
 	for (const unsigned i : lw.GetRange()) {
-		assert(i < playlist->size());
-		const auto &song = (*playlist)[i];
+		const auto &song = (*playlist)[filter.ToPosition(i)];
 
 		duration += mpd_song_get_duration(&song);
 	}
@@ -456,12 +703,14 @@ QueuePage::Update(struct mpdclient &c, unsigned events) noexcept
 		connection_name = c.GetSettingsName();
 	}
 
+	SyncFilter();
+
 	if (events & MPD_IDLE_QUEUE)
 		RestoreSelection();
 	else
 		/* the queue size may have changed, even if we havn't
 		   received the QUEUE idle event yet */
-		lw.SetLength(playlist->size());
+		UpdateLength();
 
 	if (((events & MPD_IDLE_PLAYER) != 0 && OnSongChange(c.status)) ||
 	    events & MPD_IDLE_QUEUE)
@@ -502,10 +751,12 @@ QueuePage::OnMouse(struct mpdclient &c, Point p, mmask_t bstate)
 		}
 	} else if (bstate & BUTTON3_CLICKED) {
 		/* delete */
-		if (lw.GetCursorIndex() == old_selected)
-			c.RunDelete(lw.GetCursorIndex());
+		if (lw.GetCursorIndex() == old_selected &&
+		    lw.GetCursorIndex() < lw.GetLength())
+			c.RunDelete(filter.ToPosition(lw.GetCursorIndex()));
 
-		lw.SetLength(playlist->size());
+		SyncFilter();
+		UpdateLength();
 	}
 
 	SaveSelection();
@@ -530,6 +781,11 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 		ScheduleHideCursor();
 	}
 
+	/* apply local queue edits which happened since the last
+	   update */
+	SyncFilter();
+	UpdateLength();
+
 	if (ListPage::OnCommand(c, cmd)) {
 		SaveSelection();
 		return true;
@@ -544,6 +800,8 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 		return false;
 	case Command::SELECT_PLAYING:
 		pos = c.GetCurrentSongPos();
+		if (pos >= 0)
+			pos = filter.ToRow(pos);
 		if (pos < 0)
 			return false;
 
@@ -565,6 +823,14 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 		SaveSelection();
 		SetDirty();
 		return true;
+	case Command::LIST_FUZZY_FIND:
+		screen_fuzzy_find(lw, *this, *this);
+		SaveSelection();
+		SetDirty();
+		return true;
+	case Command::LIST_FILTER:
+		EditFilter();
+		return true;
 
 #ifdef ENABLE_SONG_SCREEN
 	case Command::SCREEN_SONG:
@@ -578,8 +844,9 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 
 #ifdef ENABLE_LYRICS_SCREEN
 	case Command::SCREEN_LYRICS:
-		if (lw.GetCursorIndex() < playlist->size()) {
-			struct mpd_song &selected = (*playlist)[lw.GetCursorIndex()];
+		if (lw.GetCursorIndex() < lw.GetLength()) {
+			struct mpd_song &selected =
+				(*playlist)[filter.ToPosition(lw.GetCursorIndex())];
 			bool follow = false;
 
 			if (&selected == c.GetPlayingSong())
@@ -592,8 +859,8 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 		break;
 #endif
 	case Command::SCREEN_SWAP:
-		if (!playlist->empty())
-			screen.Swap(c, &(*playlist)[lw.GetCursorIndex()]);
+		if (lw.GetCursorIndex() < lw.GetLength())
+			screen.Swap(c, &(*playlist)[filter.ToPosition(lw.GetCursorIndex())]);
 		else
 			screen.Swap(c, nullptr);
 		return true;
@@ -608,6 +875,7 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 	switch(cmd) {
 		const struct mpd_song *song;
 		ListWindowRange range;
+		int n;
 
 	case Command::PLAY:
 		song = GetSelectedSong();
@@ -623,7 +891,30 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 
 	case Command::DELETE:
 		range = lw.GetRange();
-		c.RunDeleteRange(range.start_index, range.end_index);
+		if (filter.IsActive()) {
+			/* delete each run of consecutive queue
+			   positions, from last to first so the
+			   remaining positions stay valid */
+			for (unsigned end = range.end_index;
+			     end > range.start_index;) {
+				const unsigned last = filter.ToPosition(end - 1);
+				unsigned start = end - 1;
+				while (start > range.start_index &&
+				       filter.ToPosition(start - 1) ==
+				       last - (end - start))
+					--start;
+
+				if (!c.RunDeleteRange(filter.ToPosition(start),
+						      last + 1))
+					break;
+
+				end = start;
+			}
+
+			SyncFilter();
+			UpdateLength();
+		} else
+			c.RunDeleteRange(range.start_index, range.end_index);
 
 		lw.SetCursor(range.start_index);
 		return true;
@@ -638,9 +929,21 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 
 	case Command::SHUFFLE:
 		range = lw.GetRange();
-		if (range.end_index <= range.start_index + 1)
+		if (range.end_index <= range.start_index + 1) {
+			if (filter.IsActive()) {
+				screen_status_message(_("Cannot shuffle a filtered queue"));
+				return true;
+			}
+
 			/* No range selection, shuffle all list. */
 			break;
+		}
+
+		if (!GetPositionRange(range, range.start_index,
+				      range.end_index)) {
+			screen_status_message(_("Cannot shuffle a filtered queue"));
+			return true;
+		}
 
 		connection = c.GetConnection();
 		if (connection == nullptr)
@@ -653,26 +956,45 @@ QueuePage::OnCommand(struct mpdclient &c, Command cmd)
 			c.HandleError();
 		return true;
 
+	case Command::SORT_QUEUE:
+		SortQueue(c);
+		return true;
+
+	case Command::DEDUPE_QUEUE:
+		n = c.RunDeleteDuplicates();
+		if (n == 0)
+			screen_status_message(_("No duplicate songs in queue"));
+		else if (n > 0)
+			screen_status_printf(_("Removed %d duplicate songs"),
+					     n);
+		return true;
+
 	case Command::LIST_MOVE_UP:
 		range = lw.GetRange();
 		if (range.start_index == 0 || range.empty())
 			return false;
 
-		if (!c.RunMove(range.end_index - 1, range.start_index - 1))
+		/* move the (visible) song above the selection below
+		   it */
+		if (!c.RunMove(filter.ToPosition(range.end_index - 1),
+			       filter.ToPosition(range.start_index - 1)))
 			return true;
 
+		SyncFilter();
 		lw.SelectionMovedUp();
 		SaveSelection();
 		return true;
 
 	case Command::LIST_MOVE_DOWN:
 		range = lw.GetRange();
-		if (range.end_index >= playlist->size())
+		if (range.end_index >= lw.GetLength() || range.empty())
 			return false;
 
-		if (!c.RunMove(range.start_index, range.end_index))
+		if (!c.RunMove(filter.ToPosition(range.start_index),
+			       filter.ToPosition(range.end_index)))
 			return true;
 
+		SyncFilter();
 		lw.SelectionMovedDown();
 		SaveSelection();
 		return true;
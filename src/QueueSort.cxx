@@ -0,0 +1,333 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "QueueSort.hxx"
+#include "Queue.hxx"
+#include "strfsong.hxx"
+#include "util/StringAPI.hxx"
+#include "util/StringUTF8.hxx"
+
+#include <mpd/client.h>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Parse a list of tag names separated by spaces or commas.
+ *
+ * @return false if one of the names is not a known tag
+ */
+static bool
+ParseTagList(const char *s, std::vector<enum mpd_tag_type> &tags) noexcept
+{
+	static constexpr char separators[] = " \t,";
+
+	while (true) {
+		s += strspn(s, separators);
+		if (*s == 0)
+			return !tags.empty();
+
+		const size_t length = strcspn(s, separators);
+		const std::string name(s, length);
+		s += length;
+
+		const auto tag = mpd_tag_name_iparse(name.c_str());
+		if (tag == MPD_TAG_UNKNOWN)
+			return false;
+
+		tags.push_back(tag);
+	}
+}
+
+gcc_pure
+static bool
+IsNumericTag(enum mpd_tag_type tag) noexcept
+{
+	return tag == MPD_TAG_TRACK || tag == MPD_TAG_DISC ||
+		tag == MPD_TAG_DATE;
+}
+
+/**
+ * Compare two tag values; numeric tags (e.g. "Track") are compared
+ * by their numeric prefix first, so "2" sorts before "10".
+ */
+gcc_pure
+static int
+CompareTagValue(enum mpd_tag_type tag,
+		const char *a, const char *b) noexcept
+{
+	if (a == nullptr || b == nullptr)
+		/* songs without this tag sort first */
+		return (a != nullptr) - (b != nullptr);
+
+	if (IsNumericTag(tag)) {
+		const unsigned long na = strtoul(a, nullptr, 10);
+		const unsigned long nb = strtoul(b, nullptr, 10);
+		if (na != nb)
+			return na < nb ? -1 : 1;
+	}
+
+	return CollateUTF8(a, b);
+}
+
+static void
+SortByTags(const MpdQueue &queue, unsigned start,
+	   const std::vector<enum mpd_tag_type> &tags,
+	   std::vector<unsigned> &order) noexcept
+{
+	const size_t n_tags = tags.size();
+
+	/* look up all tag values once, not in every comparison */
+	std::vector<const char *> values(order.size() * n_tags);
+	for (size_t i = 0; i < order.size(); ++i) {
+		const auto &song = queue[start + i];
+		for (size_t j = 0; j < n_tags; ++j)
+			values[i * n_tags + j] =
+				mpd_song_get_tag(&song, tags[j], 0);
+	}
+
+	std::stable_sort(order.begin(), order.end(),
+			 [&](unsigned a, unsigned b){
+				 for (size_t j = 0; j < n_tags; ++j) {
+					 int cmp = CompareTagValue(tags[j],
+								   values[a * n_tags + j],
+								   values[b * n_tags + j]);
+					 if (cmp != 0)
+						 return cmp < 0;
+				 }
+
+				 return false;
+			 });
+}
+
+static void
+SortByFormat(const MpdQueue &queue, unsigned start, const char *format,
+	     std::vector<unsigned> &order) noexcept
+{
+	/* format all rows once, not in every comparison */
+	std::vector<std::string> keys;
+	keys.reserve(order.size());
+
+	char buffer[1024];
+	for (size_t i = 0; i < order.size(); ++i) {
+		strfsong(buffer, sizeof(buffer), format, &queue[start + i]);
+		keys.emplace_back(buffer);
+	}
+
+	std::stable_sort(order.begin(), order.end(),
+			 [&keys](unsigned a, unsigned b){
+				 return StringCollate(keys[a].c_str(),
+						      keys[b].c_str()) < 0;
+			 });
+}
+
+std::vector<unsigned>
+SortQueueOrder(const MpdQueue &queue, unsigned start, unsigned end,
+	       const char *spec) noexcept
+{
+	assert(start <= end);
+	assert(end <= queue.size());
+
+	std::vector<unsigned> order(end - start);
+	std::iota(order.begin(), order.end(), 0);
+
+	if (strchr(spec, '%') != nullptr) {
+		SortByFormat(queue, start, spec, order);
+	} else {
+		std::vector<enum mpd_tag_type> tags;
+		if (!ParseTagList(spec, tags))
+			return {};
+
+		SortByTags(queue, start, tags, order);
+	}
+
+	return order;
+}
+
+/**
+ * Find a longest increasing subsequence of the given sequence.
+ *
+ * @return a flag for each element: is it part of the subsequence?
+ */
+static std::vector<bool>
+LongestIncreasingSubsequence(const std::vector<unsigned> &sequence) noexcept
+{
+	const size_t n = sequence.size();
+
+	/* tails[k] = index of the smallest tail of all increasing
+	   subsequences with length k+1 */
+	std::vector<unsigned> tails;
+	std::vector<unsigned> previous(n);
+
+	for (unsigned i = 0; i < n; ++i) {
+		auto t = std::lower_bound(tails.begin(), tails.end(),
+					  sequence[i],
+					  [&sequence](unsigned a, unsigned value){
+						  return sequence[a] < value;
+					  });
+
+		previous[i] = t == tails.begin() ? unsigned(-1) : *std::prev(t);
+
+		if (t == tails.end())
+			tails.push_back(i);
+		else
+			*t = i;
+	}
+
+	std::vector<bool> result(n, false);
+	if (!tails.empty())
+		for (unsigned i = tails.back(); i != unsigned(-1);
+		     i = previous[i])
+			result[i] = true;
+
+	return result;
+}
+
+/**
+ * A Fenwick tree counting the occupied slots in an ordered list.
+ */
+class SlotCounter {
+	std::vector<unsigned> tree;
+
+public:
+	explicit SlotCounter(size_t n) noexcept
+		:tree(n + 1, 0) {}
+
+	void Add(size_t slot, int delta) noexcept {
+		for (++slot; slot < tree.size(); slot += slot & -slot)
+			tree[slot] += delta;
+	}
+
+	/**
+	 * Count the occupied slots before the given one.
+	 */
+	gcc_pure
+	unsigned CountBefore(size_t slot) const noexcept {
+		unsigned result = 0;
+		for (; slot > 0; slot -= slot & -slot)
+			result += tree[slot];
+		return result;
+	}
+};
+
+std::vector<QueueMove>
+PlanQueueMoves(const std::vector<unsigned> &order) noexcept
+{
+	const unsigned n = order.size();
+
+	/* rank[p] = the new position of the song at position p */
+	std::vector<unsigned> rank(n);
+	for (unsigned i = 0; i < n; ++i)
+		rank[order[i]] = i;
+
+	/* the longest increasing subsequence of ranks stays in
+	   place; all other songs get moved */
+	const auto stays = LongestIncreasingSubsequence(rank);
+
+	/* The songs are processed in their new order; each song
+	   which is moved gets inserted right after its predecessor
+	   (in the new order), which is already in its final
+	   place.  This way, moved songs form "chains" after a song
+	   which stays (the "anchor"), or at the front of the list.
+	   Each song occupies a slot in the following order: anchor
+	   0 (the front) with its chain, then the song at position 0
+	   followed by its chain, etc. */
+
+	/* chain_length[a] = number of songs moved after anchor a,
+	   where a=0 is the front and a=p+1 is the song at position
+	   p */
+	std::vector<unsigned> chain_length(n + 1, 0);
+
+	/* anchor/chain index of the new slot of each moved song
+	   (indexed by new position) */
+	std::vector<unsigned> target_anchor(n), target_index(n);
+
+	for (unsigned r = 0; r < n; ++r) {
+		if (stays[order[r]])
+			continue;
+
+		unsigned anchor;
+		if (r == 0)
+			anchor = 0;
+		else if (stays[order[r - 1]])
+			anchor = order[r - 1] + 1;
+		else
+			anchor = target_anchor[r - 1];
+
+		target_anchor[r] = anchor;
+		target_index[r] = chain_length[anchor]++;
+	}
+
+	/* base[a] = the slot of anchor a (or of its first chain
+	   element, for the front) */
+	std::vector<unsigned> base(n + 2);
+	base[0] = 0;
+	for (unsigned a = 0; a <= n; ++a)
+		base[a + 1] = base[a] + (a > 0) + chain_length[a];
+
+	const auto initial_slot = [&base](unsigned p){
+		return base[p + 1];
+	};
+
+	const auto target_slot = [&](unsigned r){
+		const unsigned anchor = target_anchor[r];
+		return base[anchor] + (anchor > 0) + target_index[r];
+	};
+
+	SlotCounter slots(base[n + 1]);
+	for (unsigned p = 0; p < n; ++p)
+		slots.Add(initial_slot(p), 1);
+
+	std::vector<QueueMove> moves;
+
+	for (unsigned r = 0; r < n;) {
+		const unsigned p = order[r];
+		if (stays[p]) {
+			++r;
+			continue;
+		}
+
+		/* combine adjacent songs which are moved to the same
+		   chain to one range */
+		unsigned length = 1;
+		while (r + length < n && order[r + length] == p + length &&
+		       !stays[p + length])
+			++length;
+
+		const unsigned src = slots.CountBefore(initial_slot(p));
+		for (unsigned i = 0; i < length; ++i)
+			slots.Add(initial_slot(p + i), -1);
+
+		const unsigned dest = slots.CountBefore(target_slot(r));
+		for (unsigned i = 0; i < length; ++i)
+			slots.Add(target_slot(r + i), 1);
+
+		if (src != dest)
+			moves.push_back({src, src + length, dest});
+
+		r += length;
+	}
+
+	return moves;
+}
@@ -0,0 +1,63 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_QUEUE_SORT_HXX
+#define NCMPC_QUEUE_SORT_HXX
+
+#include "util/Compiler.h"
+
+#include <vector>
+
+struct MpdQueue;
+
+/**
+ * One "move" command: move the songs in the range [start, end) so
+ * that the range begins at position #to of the resulting queue.
+ */
+struct QueueMove {
+	unsigned start, end, to;
+};
+
+/**
+ * Determine the new order of the songs in the queue range [start,
+ * end).
+ *
+ * @param spec a song format (see strfsong()) or a list of tag names
+ * separated by spaces or commas
+ * @return a permutation: element i is the (relative) position of
+ * the song which shall be moved to relative position i; an empty
+ * vector if the specification could not be parsed
+ */
+gcc_pure
+std::vector<unsigned>
+SortQueueOrder(const MpdQueue &queue, unsigned start, unsigned end,
+	       const char *spec) noexcept;
+
+/**
+ * Calculate a short list of "move" commands which reorders a list
+ * according to the given permutation (see SortQueueOrder()).  The
+ * longest increasing subsequence of songs remains in place, and
+ * adjacent songs moving to the same place are combined to one range
+ * move.
+ */
+gcc_pure
+std::vector<QueueMove>
+PlanQueueMoves(const std::vector<unsigned> &order) noexcept;
+
+#endif
@@ -27,11 +27,15 @@
 #include "GlobalBindings.hxx"
 #include "charset.hxx"
 #include "mpdclient.hxx"
+#include "screen.hxx"
 #include "screen_utils.hxx"
 #include "FileListPage.hxx"
 #include "filelist.hxx"
+#include "UriSet.hxx"
 #include "util/Macros.hxx"
 
+#include <utility>
+
 #include <string.h>
 
 enum {
@@ -103,10 +107,29 @@ static const char *const help_text[] = {
 
 static bool advanced_search_mode = false;
 
-class SearchPage final : public FileListPage {
+class SearchPage final : public FileListPage, MpdEntityHandler {
 	History search_history;
 	std::string pattern;
 
+	/**
+	 * The client which is currently receiving search results for
+	 * this page, or nullptr.
+	 */
+	struct mpdclient *receiving = nullptr;
+
+	/**
+	 * The URIs of all songs received so far; only used if
+	 * #remove_duplicates is set.  The strings are owned by
+	 * #filelist.
+	 */
+	UriSet found_uris;
+
+	/**
+	 * Shall songs which have already been received be skipped?
+	 * This is used when the results of two searches are merged.
+	 */
+	bool remove_duplicates = false;
+
 public:
 	SearchPage(ScreenManager &_screen, WINDOW *_w, Size size)
 		:FileListPage(_screen, _w, size,
@@ -117,11 +140,38 @@ public:
 		lw.SetLength(ARRAY_SIZE(help_text));
 	}
 
+	~SearchPage() noexcept override {
+		CancelSearch();
+	}
+
 private:
 	void Clear(bool clear_pattern);
 	void Reload(struct mpdclient &c);
 	void Start(struct mpdclient &c);
 
+	/**
+	 * Stop receiving search results.
+	 */
+	void CancelSearch() noexcept {
+		if (receiving != nullptr) {
+			receiving->CancelReceiveEntities(*this);
+			receiving = nullptr;
+		}
+
+		found_uris.clear();
+	}
+
+	/**
+	 * Show the search results received so far.
+	 */
+	void ShowResults(const struct mpdclient &c) noexcept;
+
+	/* virtual methods from class MpdEntityHandler */
+	bool AcceptEntity(const struct mpd_pair &pair) noexcept override;
+	void OnEntity(struct mpd_entity &entity) noexcept override;
+	void OnEntityPortion() noexcept override;
+	void OnEntityEnd(bool success) noexcept override;
+
 public:
 	/* virtual methods from class Page */
 	void Paint() const noexcept override;
@@ -162,10 +212,13 @@ public:
 void
 SearchPage::Clear(bool clear_pattern)
 {
+	CancelSearch();
+
 	if (filelist) {
 		delete filelist;
 		filelist = new FileList();
-		lw.SetLength(0);
+		InvalidateCaches();
+		UpdateLength();
 	}
 	if (clear_pattern)
 		pattern.clear();
@@ -173,14 +226,20 @@ SearchPage::Clear(bool clear_pattern)
 	SetDirty();
 }
 
-static FileList *
-search_simple_query(struct mpd_connection *connection, bool exact_match,
-		    int table, const char *local_pattern)
+/**
+ * Send a search command for the given search mode.  The response is
+ * a list of songs.
+ */
+static void
+search_send_simple_query(struct mpd_connection *connection, bool exact_match,
+			 int table, const char *local_pattern)
 {
-	FileList *list;
 	const LocaleToUtf8 filter_utf8(local_pattern);
 
 	if (table == SEARCH_ARTIST_TITLE) {
+		/* MPD can't combine constraints with "or", so send
+		   both searches in one command list; the caller
+		   merges the responses */
 		mpd_command_list_begin(connection, false);
 
 		mpd_search_db_songs(connection, exact_match);
@@ -196,27 +255,18 @@ search_simple_query(struct mpd_connection *connection, bool exact_match,
 		mpd_search_commit(connection);
 
 		mpd_command_list_end(connection);
-
-		list = filelist_new_recv(connection);
-		list->RemoveDuplicateSongs();
 	} else if (table == SEARCH_URI) {
 		mpd_search_db_songs(connection, exact_match);
 		mpd_search_add_uri_constraint(connection, MPD_OPERATOR_DEFAULT,
 					      filter_utf8.c_str());
 		mpd_search_commit(connection);
-
-		list = filelist_new_recv(connection);
 	} else {
 		mpd_search_db_songs(connection, exact_match);
 		mpd_search_add_tag_constraint(connection, MPD_OPERATOR_DEFAULT,
 					      (enum mpd_tag_type)table,
 					      filter_utf8.c_str());
 		mpd_search_commit(connection);
-
-		list = filelist_new_recv(connection);
 	}
-
-	return list;
 }
 
 /*-----------------------------------------------------------------------
@@ -224,12 +274,12 @@ search_simple_query(struct mpd_connection *connection, bool exact_match,
  *       Its ugly and MUST be redesigned before the next release!
  *-----------------------------------------------------------------------
  */
-static FileList *
-search_advanced_query(struct mpd_connection *connection, const char *query)
+static bool
+search_send_advanced_query(struct mpd_connection *connection, const char *query)
 {
 	advanced_search_mode = false;
 	if (strchr(query, ':') == nullptr)
-		return nullptr;
+		return false;
 
 	std::string str(query);
 
@@ -262,7 +312,7 @@ search_advanced_query(struct mpd_connection *connection, const char *query)
 			if (table[n] < 0) {
 				screen_status_printf(_("Bad search tag %s"),
 						     tabv[n]);
-				return nullptr;
+				return false;
 			}
 
 			++n;
@@ -275,7 +325,7 @@ search_advanced_query(struct mpd_connection *connection, const char *query)
 	/* Get rid of obvious failure case */
 	if (matchv[n - 1][0] == '\0') {
 		screen_status_printf(_("No argument for search tag %s"), tabv[n - 1]);
-		return nullptr;
+		return false;
 	}
 
 	advanced_search_mode = true;
@@ -304,55 +354,92 @@ search_advanced_query(struct mpd_connection *connection, const char *query)
 	}
 
 	mpd_search_commit(connection);
-	auto *fl = filelist_new_recv(connection);
-	if (!mpd_response_finish(connection)) {
-		delete fl;
-		fl = nullptr;
-	}
-
-	return fl;
+	return true;
 }
 
-static FileList *
-do_search(struct mpdclient *c, const char *query)
+void
+SearchPage::Reload(struct mpdclient &c)
 {
-	auto *connection = c->GetConnection();
+	if (pattern.empty())
+		return;
+
+	CancelSearch();
+
+	lw.EnableCursor();
+	delete filelist;
+	filelist = new FileList();
+	InvalidateCaches();
+	UpdateLength();
+	SetDirty();
+
+	auto *connection = c.GetConnection();
 	if (connection == nullptr)
-		return nullptr;
+		return;
 
-	auto *fl = search_advanced_query(connection, query);
-	if (fl != nullptr)
-		return fl;
+	remove_duplicates = false;
+
+	if (!search_send_advanced_query(connection, pattern.c_str())) {
+		if (mpd_connection_get_error(connection) != MPD_ERROR_SUCCESS) {
+			c.HandleError();
+			return;
+		}
 
-	if (mpd_connection_get_error(connection) != MPD_ERROR_SUCCESS) {
-		c->HandleError();
-		return nullptr;
+		const int table = mode[options.search_mode].table;
+		search_send_simple_query(connection, false, table,
+					 pattern.c_str());
+		remove_duplicates = table == SEARCH_ARTIST_TITLE;
 	}
 
-	fl = search_simple_query(connection, false,
-				 mode[options.search_mode].table,
-				 query);
-	if (fl == nullptr)
-		c->HandleError();
-	return fl;
+	/* receive the results in portions, so they can be painted
+	   while more are arriving, and the search can be
+	   interrupted */
+	receiving = &c;
+	c.ReceiveEntitiesAsync(*this);
 }
 
 void
-SearchPage::Reload(struct mpdclient &c)
+SearchPage::ShowResults(const struct mpdclient &c) noexcept
 {
-	if (pattern.empty())
-		return;
+	InvalidateCaches();
+	UpdateLength();
+	SyncHighlights(c.playlist);
 
-	lw.EnableCursor();
-	delete filelist;
-	filelist = do_search(&c, pattern.c_str());
-	if (filelist == nullptr)
-		filelist = new FileList();
-	lw.SetLength(filelist->size());
+	SetDirty();
+	if (screen.IsVisible(*this))
+		screen.Paint(true);
+}
 
-	screen_browser_sync_highlights(filelist, &c.playlist);
+bool
+SearchPage::AcceptEntity(const struct mpd_pair &pair) noexcept
+{
+	/* drop duplicates before they get parsed and allocated */
+	return !remove_duplicates || strcmp(pair.name, "file") != 0 ||
+		found_uris.find(pair.value) == found_uris.end();
+}
 
-	SetDirty();
+void
+SearchPage::OnEntity(struct mpd_entity &entity) noexcept
+{
+	filelist->emplace_back(&entity);
+
+	if (remove_duplicates &&
+	    mpd_entity_get_type(&entity) == MPD_ENTITY_TYPE_SONG)
+		found_uris.emplace(mpd_song_get_uri(mpd_entity_get_song(&entity)));
+}
+
+void
+SearchPage::OnEntityPortion() noexcept
+{
+	ShowResults(*receiving);
+}
+
+void
+SearchPage::OnEntityEnd(gcc_unused bool success) noexcept
+{
+	const auto &c = *std::exchange(receiving, nullptr);
+	found_uris.clear();
+
+	ShowResults(c);
 }
 
 void
@@ -412,10 +499,8 @@ SearchPage::GetTitle(char *str, size_t size) const noexcept
 void
 SearchPage::Update(struct mpdclient &c, unsigned events) noexcept
 {
-	if (filelist != nullptr && events & MPD_IDLE_QUEUE) {
-		screen_browser_sync_highlights(filelist, &c.playlist);
+	if (events & MPD_IDLE_QUEUE && SyncHighlights(c.playlist))
 		SetDirty();
-	}
 }
 
 bool
@@ -442,6 +527,15 @@ SearchPage::OnCommand(struct mpdclient &c, Command cmd)
 		Reload(c);
 		return true;
 
+	case Command::INTERRUPT:
+		if (receiving == nullptr)
+			break;
+
+		CancelSearch();
+		ShowResults(c);
+		screen_status_message(_("Search interrupted"));
+		return true;
+
 	case Command::SCREEN_SEARCH:
 		Start(c);
 		return true;
@@ -0,0 +1,138 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "SortKey.hxx"
+#include "Parallel.hxx"
+#include "Options.hxx"
+#include "util/CharUtil.hxx"
+#include "util/StringUTF8.hxx"
+
+#include <algorithm>
+#include <numeric>
+
+#include <string.h>
+
+/**
+ * Lists with at least this many items are sorted in several
+ * threads.
+ */
+static constexpr size_t PARALLEL_THRESHOLD = 16384;
+
+/**
+ * Append a number so that plain string comparisons order it by its
+ * value: leading zeroes are removed, and the digits are preceded by
+ * their count, so longer numbers sort after shorter ones.  The count
+ * L = 9q + r is written as q nines followed by the digit r, which
+ * keeps even long counts in order.
+ */
+static void
+AppendNumber(std::string &dest, const char *s, size_t length) noexcept
+{
+	while (length > 1 && *s == '0') {
+		++s;
+		--length;
+	}
+
+	dest.append(length / 9, '9');
+	dest.push_back(char('0' + length % 9));
+	dest.append(s, length);
+}
+
+/**
+ * Calculate a key which compares digit sequences by their numeric
+ * value.
+ *
+ * The intended order is the locale's collation of the whole string,
+ * in which all primary weights (base letters, digits) are compared
+ * before any secondary weights (accents) or tertiary weights
+ * (case), so "Émile 1" sorts before "Emile 2".  Therefore the digit
+ * sequences are rewritten with AppendNumber(), and the whole string
+ * is passed to CollateKeyUTF8() once; concatenating the keys of the
+ * segments would compare the accents of one segment before the
+ * letters and digits of the next one.
+ */
+static std::string
+MakeNaturalSortKey(const char *s) noexcept
+{
+	std::string buffer;
+
+	while (*s != 0) {
+		const char *end = s;
+		if (IsDigitASCII(*s)) {
+			while (IsDigitASCII(*end))
+				++end;
+
+			AppendNumber(buffer, s, end - s);
+		} else {
+			while (*end != 0 && !IsDigitASCII(*end))
+				++end;
+
+			buffer.append(s, end);
+		}
+
+		s = end;
+	}
+
+	return CollateKeyUTF8(buffer.c_str());
+}
+
+std::string
+MakeSortKey(const char *s) noexcept
+{
+	return options.natural_sort
+		? MakeNaturalSortKey(s)
+		: CollateKeyUTF8(s);
+}
+
+std::vector<unsigned>
+SortByKeys(size_t n,
+	   const std::function<std::string(size_t)> &make_key) noexcept
+{
+	const unsigned n_threads = CountThreads(n, PARALLEL_THRESHOLD);
+
+	std::vector<std::string> keys(n);
+	ParallelSlices(n, n_threads,
+		       [&keys, &make_key](unsigned, size_t start, size_t end){
+			for (size_t i = start; i < end; ++i)
+				keys[i] = make_key(i);
+		});
+
+	std::vector<unsigned> order(n);
+	std::iota(order.begin(), order.end(), 0);
+
+	const auto compare = [&keys](unsigned a, unsigned b){
+		return keys[a] < keys[b];
+	};
+
+	/* sort the slices, then merge them; both steps are stable */
+	ParallelSlices(n, n_threads,
+		       [&order, &compare](unsigned, size_t start, size_t end){
+			std::stable_sort(std::next(order.begin(), start),
+					 std::next(order.begin(), end),
+					 compare);
+		});
+
+	for (unsigned i = 1; i < n_threads; ++i)
+		std::inplace_merge(order.begin(),
+				   std::next(order.begin(), n * i / n_threads),
+				   std::next(order.begin(), n * (i + 1) / n_threads),
+				   compare);
+
+	return order;
+}
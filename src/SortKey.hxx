@@ -0,0 +1,57 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_SORT_KEY_HXX
+#define NCMPC_SORT_KEY_HXX
+
+#include "util/Compiler.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+
+/**
+ * Calculate a key for sorting the given UTF-8 string.  Comparing two
+ * keys with std::string::compare() is much cheaper than collating
+ * the strings, and yields the same order as CollateUTF8(), or a
+ * natural-number-aware order if the "natural-sort" option is
+ * enabled ("track 2" before "track 10").
+ */
+gcc_pure
+std::string
+MakeSortKey(const char *s) noexcept;
+
+/**
+ * Sort a list by keys which are calculated once per item.  Large
+ * lists are processed in several threads.
+ *
+ * @param n the number of items
+ * @param make_key a function which calculates the key of item #i
+ * (e.g. with MakeSortKey()); it may be called in worker threads
+ * @return a permutation: element i is the index of the item which
+ * belongs to position i; items with equal keys retain their relative
+ * order
+ */
+std::vector<unsigned>
+SortByKeys(size_t n,
+	   const std::function<std::string(size_t)> &make_key) noexcept;
+
+#endif
@@ -0,0 +1,56 @@
+/* ncmpc (Ncurses MPD Client)
+ * (c) 2004-2019 The Music Player Daemon Project
+ * Project homepage: http://musicpd.org
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef NCMPC_STRING_SET_HXX
+#define NCMPC_STRING_SET_HXX
+
+#include "util/Compiler.h"
+
+#include <unordered_set>
+
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * FNV-1a hash of a null-terminated string.
+ */
+struct CStringHash {
+	gcc_pure
+	size_t operator()(const char *s) const noexcept {
+		size_t hash = 2166136261u;
+		for (; *s != 0; ++s)
+			hash = (hash ^ (unsigned char)*s) * 16777619u;
+		return hash;
+	}
+};
+
+struct CStringEqual {
+	gcc_pure
+	bool operator()(const char *a, const char *b) const noexcept {
+		return strcmp(a, b) == 0;
+	}
+};
+
+/**
+ * A set of null-terminated strings.  It does not copy the strings;
+ * they must remain valid as long as they are in the set.
+ */
+using StringSet = std::unordered_set<const char *, CStringHash, CStringEqual>;
+
+#endif
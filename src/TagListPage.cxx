@@ -25,9 +25,11 @@
 #include "i18n.h"
 #include "charset.hxx"
 #include "mpdclient.hxx"
-#include "util/StringUTF8.hxx"
-
-#include <algorithm>
+#include "LibraryTree.hxx"
+#include "LibraryCache.hxx"
+#include "ListDiff.hxx"
+#include "SortKey.hxx"
+#include "StringSet.hxx"
 
 #include <assert.h>
 #include <string.h>
@@ -49,13 +51,6 @@ TagListPage::MakeCursorFilter() const noexcept
 	return new_filter;
 }
 
-gcc_pure
-static bool
-CompareUTF8(const std::string &a, const std::string &b)
-{
-	return CollateUTF8(a.c_str(), b.c_str()) < 0;
-}
-
 const char *
 TagListPage::GetListItemText(char *buffer, size_t size,
 			     unsigned idx) const noexcept
@@ -88,25 +83,107 @@ recv_tag_values(struct mpd_connection *connection, enum mpd_tag_type tag,
 }
 
 void
-TagListPage::LoadValues(struct mpdclient &c) noexcept
+TagListPage::StashValues() noexcept
 {
-	auto *connection = c.GetConnection();
+	if (cache != nullptr && !values.empty() &&
+	    !HasPendingEvents(MPD_IDLE_DATABASE))
+		cache->values.Put({tag, filter}, std::move(values));
 
 	values.clear();
+}
+
+void
+TagListPage::QueryValues(struct mpdclient &c,
+			 std::vector<std::string> &dest) const noexcept
+{
+	auto *connection = c.GetConnection();
+
+	std::vector<std::string> new_values;
 
 	if (connection != nullptr) {
 		mpd_search_db_tags(connection, tag);
 		AddConstraints(connection, filter);
 		mpd_search_commit(connection);
 
-		recv_tag_values(connection, tag, values);
+		recv_tag_values(connection, tag, new_values);
 
 		c.FinishCommand();
 	}
 
 	/* sort list */
-	std::sort(values.begin(), values.end(), CompareUTF8);
-	lw.SetLength((parent != nullptr) + values.size() + (all_text != nullptr));
+	const auto order = SortByKeys(new_values.size(),
+				      [&new_values](size_t i){
+					      return MakeSortKey(new_values[i].c_str());
+				      });
+
+	dest.reserve(new_values.size());
+	for (unsigned i : order)
+		dest.emplace_back(std::move(new_values[i]));
+}
+
+void
+TagListPage::LoadValues(struct mpdclient &c) noexcept
+{
+	std::vector<std::string> new_values;
+
+	if (values.empty() && cache != nullptr &&
+	    cache->values.Take({tag, filter}, new_values)) {
+		/* this list was displayed recently and the database
+		   has not changed since */
+	} else if (tree == nullptr || !tree->Load(c) ||
+		   !tree->Find(tag, filter, new_values))
+		/* the whole hierarchy is usually loaded in one
+		   query; ask MPD only if the tree is not
+		   available */
+		QueryValues(c, new_values);
+
+	const unsigned offset = parent != nullptr;
+	const unsigned new_length = offset + new_values.size() +
+		(all_text != nullptr);
+
+	if (values.empty()) {
+		values = std::move(new_values);
+		lw.SetLength(new_length);
+		SetDirty();
+		return;
+	}
+
+	/* merge with the old list, so the cursor stays on the same
+	   value; both lists are sorted the same way, so the values
+	   which exist in both lists have the same relative order */
+	StringSet old_set, new_set;
+	old_set.reserve(values.size());
+	for (const auto &i : values)
+		old_set.emplace(i.c_str());
+	new_set.reserve(new_values.size());
+	for (const auto &i : new_values)
+		new_set.emplace(i.c_str());
+
+	auto diff = DiffLists(values.size(), new_values.size(),
+			      [this, &new_values](unsigned i, unsigned j){
+				      return values[i] == new_values[j];
+			      },
+			      [this, &new_set](unsigned i){
+				      return new_set.find(values[i].c_str()) != new_set.end();
+			      },
+			      [&new_values, &old_set](unsigned j){
+				      return old_set.find(new_values[j].c_str()) != old_set.end();
+			      });
+
+	values = std::move(new_values);
+
+	if (diff.empty())
+		return;
+
+	/* account for the ".." item */
+	if (offset > 0) {
+		for (auto &i : diff.map)
+			i += offset;
+		diff.map.insert(diff.map.begin(), 0);
+	}
+
+	ApplyListDiff(lw, diff, new_length);
+	SetDirty();
 }
 
 void
@@ -159,10 +236,14 @@ TagListPage::GetTitle(char *, size_t) const noexcept
 void
 TagListPage::Update(struct mpdclient &c, unsigned events) noexcept
 {
+	if (c.IsUpdatingDatabase() && (events & MPD_IDLE_UPDATE) == 0)
+		/* a database update is still running: reload only
+		   once after it has finished */
+		PostponeEvents(events, MPD_IDLE_DATABASE);
+
 	if (events & MPD_IDLE_DATABASE) {
 		/* the db has changed -> update the list */
 		Reload(c);
-		SetDirty();
 	}
 }
 
@@ -241,6 +322,11 @@ TagListPage::OnCommand(struct mpdclient &c, Command cmd)
 		SetDirty();
 		return true;
 
+	case Command::LIST_FUZZY_FIND:
+		screen_fuzzy_find(lw, *this, *this);
+		SetDirty();
+		return true;
+
 	default:
 		break;
 	}
@@ -29,11 +29,25 @@
 #include <string>
 
 class ScreenManager;
+class LibraryTree;
+struct LibraryCache;
 
 class TagListPage final : public ListPage, ListRenderer, ListText {
 	ScreenManager &screen;
 	Page *const parent;
 
+	/**
+	 * If not nullptr, then values are looked up here before
+	 * asking MPD.
+	 */
+	LibraryTree *const tree;
+
+	/**
+	 * If not nullptr, then the values of the previous filter are
+	 * stored here when the filter changes.
+	 */
+	LibraryCache *const cache;
+
 	const enum mpd_tag_type tag;
 	const char *const all_text;
 
@@ -44,10 +58,12 @@ class TagListPage final : public ListPage, ListRenderer, ListText {
 
 public:
 	TagListPage(ScreenManager &_screen, Page *_parent,
+		    LibraryTree *_tree, LibraryCache *_cache,
 		    const enum mpd_tag_type _tag,
 		    const char *_all_text,
 		    WINDOW *_w, Size size) noexcept
 		:ListPage(_w, size), screen(_screen), parent(_parent),
+		 tree(_tree), cache(_cache),
 		 tag(_tag), all_text(_all_text) {}
 
 	auto GetTag() const noexcept {
@@ -60,6 +76,10 @@ public:
 
 	template<typename F>
 	void SetFilter(F &&_filter) noexcept {
+		/* this is a different list; don't merge with the old
+		   one */
+		StashValues();
+
 		filter = std::forward<F>(_filter);
 		AddPendingEvents(~0u);
 	}
@@ -91,6 +111,18 @@ public:
 	}
 
 private:
+	/**
+	 * Move the values to the #LibraryCache (if they are
+	 * up-to-date) and clear the list.
+	 */
+	void StashValues() noexcept;
+
+	/**
+	 * Ask MPD for the (sorted) values.
+	 */
+	void QueryValues(struct mpdclient &c,
+			 std::vector<std::string> &dest) const noexcept;
+
 	void LoadValues(struct mpdclient &c) noexcept;
 	void Reload(struct mpdclient &c);
 
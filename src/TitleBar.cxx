@@ -21,6 +21,7 @@
 #include "TabBar.hxx"
 #include "Styles.hxx"
 #include "Options.hxx"
+#include "DelayedVolume.hxx"
 #include "i18n.h"
 #include "util/LocaleString.hxx"
 
@@ -51,9 +52,13 @@ get_volume(const struct mpd_status *status) noexcept
 }
 
 void
-TitleBar::Update(const struct mpd_status *status) noexcept
+TitleBar::Update(const struct mpd_status *status,
+		 const DelayedVolume &delayed_volume) noexcept
 {
-	volume = get_volume(status);
+	/* show the new volume before MPD has applied it */
+	volume = delayed_volume.IsPending()
+		? delayed_volume.GetVolume()
+		: get_volume(status);
 
 	char *p = flags;
 	if (status != nullptr) {
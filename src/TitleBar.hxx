@@ -24,6 +24,7 @@
 
 struct mpd_status;
 struct PageMeta;
+class DelayedVolume;
 
 class TitleBar {
 	Window window;
@@ -39,7 +40,8 @@ public:
 	}
 
 	void OnResize(unsigned width) noexcept;
-	void Update(const struct mpd_status *status) noexcept;
+	void Update(const struct mpd_status *status,
+		    const DelayedVolume &delayed_volume) noexcept;
 	void Paint(const PageMeta &current_page_meta,
 		   const char *title) const noexcept;
 };
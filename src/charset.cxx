@@ -43,6 +43,16 @@ charset_init() noexcept
 }
 #endif
 
+bool
+IsLocaleUtf8() noexcept
+{
+#ifdef HAVE_ICONV
+	return noconvert;
+#else
+	return true;
+#endif
+}
+
 static char *
 CopyTruncateString(char *dest, size_t dest_size,
 		   const char *src, size_t src_length) noexcept
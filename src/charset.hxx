@@ -32,6 +32,14 @@ void
 charset_init() noexcept;
 #endif
 
+/**
+ * Is the locale charset UTF-8?  Without iconv, strings are never
+ * converted, so this is assumed.
+ */
+gcc_pure
+bool
+IsLocaleUtf8() noexcept;
+
 char *
 CopyUtf8ToLocale(char *dest, size_t dest_size, const char *src) noexcept;
 
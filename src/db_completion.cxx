@@ -18,49 +18,127 @@
  */
 
 #include "db_completion.hxx"
-#include "Completion.hxx"
+#include "PathTrie.hxx"
 #include "charset.hxx"
 #include "mpdclient.hxx"
-#include "util/ScopeExit.hxx"
 
+#include <set>
 #include <string>
 
+#include <string.h>
+
+namespace {
+
+/**
+ * A completion list which is kept until the database changes or
+ * the connection is replaced.
+ */
+struct CompletionCache {
+	PathTrie list;
+
+	/**
+	 * The directories (in the locale charset) whose contents have
+	 * been added to #list.
+	 */
+	std::set<std::string> loaded;
+
+	/**
+	 * The mpdclient::connection_id and
+	 * mpdclient::database_serial values when #list was filled.
+	 */
+	unsigned connection_id = 0, database_serial = 0;
+
+	/**
+	 * Clear the list if it is outdated.
+	 */
+	void Validate(const struct mpdclient &c) noexcept {
+		if (c.connection_id == connection_id &&
+		    c.database_serial == database_serial)
+			return;
+
+		list.clear();
+		loaded.clear();
+		connection_id = c.connection_id;
+		database_serial = c.database_serial;
+	}
+};
+
+}
+
+static CompletionCache database_completion, playlist_completion;
+
+PathTrie &
+GetDatabaseCompletionList(struct mpdclient &c) noexcept
+{
+	database_completion.Validate(c);
+	return database_completion.list;
+}
+
 void
-gcmp_list_from_path(struct mpdclient *c, const char *path,
-		    Completion &completion,
-		    int types)
+LoadDatabaseCompletion(struct mpdclient &c, const char *path) noexcept
 {
-	auto *connection = c->GetConnection();
-	if (connection == nullptr)
-		return;
+	auto &cache = database_completion;
+	cache.Validate(c);
 
-	mpd_send_list_meta(connection, path);
+	if (!cache.loaded.emplace(path).second)
+		/* already loaded */
+		return;
 
-	struct mpd_entity *entity;
-	while ((entity = mpd_recv_entity(connection)) != nullptr) {
-		AtScopeExit(entity) { mpd_entity_free(entity); };
+	auto *connection = c.GetConnection();
+	if (connection == nullptr ||
+	    !mpd_send_list_meta(connection, LocaleToUtf8(path).c_str())) {
+		cache.loaded.erase(path);
+		return;
+	}
 
-		std::string name;
-		if (mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_DIRECTORY &&
-		    types & GCMP_TYPE_DIR) {
-			const struct mpd_directory *dir =
-				mpd_entity_get_directory(entity);
-			name = Utf8ToLocale(mpd_directory_get_path(dir)).c_str();
+	/* collect only the names instead of parsing the song
+	   metadata into mpd_entity objects */
+	struct mpd_pair *pair;
+	while ((pair = mpd_recv_pair(connection)) != nullptr) {
+		if (strcmp(pair->name, "directory") == 0) {
+			std::string name = Utf8ToLocale(pair->value).c_str();
 			name.push_back('/');
-		} else if (mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_SONG &&
-			   types & GCMP_TYPE_FILE) {
-			const struct mpd_song *song =
-				mpd_entity_get_song(entity);
-			name = Utf8ToLocale(mpd_song_get_uri(song)).c_str();
-		} else if (mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_PLAYLIST &&
-			   types & GCMP_TYPE_PLAYLIST) {
-			const struct mpd_playlist *playlist =
-				mpd_entity_get_playlist(entity);
-			name = Utf8ToLocale(mpd_playlist_get_path(playlist)).c_str();
-		} else {
-			continue;
-		}
-
-		completion.emplace(std::move(name));
+			cache.list.Insert(name);
+		} else if (strcmp(pair->name, "file") == 0)
+			cache.list.Insert(Utf8ToLocale(pair->value).c_str());
+
+		mpd_return_pair(connection, pair);
+	}
+
+	if (!c.FinishCommand())
+		/* try again next time */
+		cache.loaded.erase(path);
+}
+
+PathTrie &
+GetPlaylistCompletionList(struct mpdclient &c) noexcept
+{
+	playlist_completion.Validate(c);
+	return playlist_completion.list;
+}
+
+void
+LoadPlaylistCompletion(struct mpdclient &c) noexcept
+{
+	auto &cache = playlist_completion;
+	cache.Validate(c);
+
+	if (!cache.loaded.emplace().second)
+		/* already loaded */
+		return;
+
+	auto *connection = c.GetConnection();
+	if (connection == nullptr || !mpd_send_list_playlists(connection)) {
+		cache.loaded.clear();
+		return;
+	}
+
+	struct mpd_pair *pair;
+	while ((pair = mpd_recv_pair_named(connection, "playlist")) != nullptr) {
+		cache.list.Insert(Utf8ToLocale(pair->value).c_str());
+		mpd_return_pair(connection, pair);
 	}
+
+	if (!c.FinishCommand())
+		cache.loaded.clear();
 }
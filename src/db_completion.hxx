@@ -21,20 +21,38 @@
 #define DB_COMPLETION_H
 
 struct mpdclient;
-class Completion;
+class PathTrie;
 
-#define GCMP_TYPE_DIR       (0x01 << 0)
-#define GCMP_TYPE_FILE      (0x01 << 1)
-#define GCMP_TYPE_PLAYLIST  (0x01 << 2)
-#define GCMP_TYPE_RFILE     (GCMP_TYPE_DIR | GCMP_TYPE_FILE)
-#define GCMP_TYPE_RPLAYLIST (GCMP_TYPE_DIR | GCMP_TYPE_PLAYLIST)
+/**
+ * Returns the list of database paths (in the locale charset) for
+ * completion.  It persists across prompts and is cleared when the
+ * database changes.  Directories are added to it by
+ * LoadDatabaseCompletion().
+ */
+PathTrie &
+GetDatabaseCompletionList(struct mpdclient &c) noexcept;
+
+/**
+ * Add the contents of the given directory (in the locale charset;
+ * an empty string is the root directory) to the database completion
+ * list, unless that has already been done.
+ */
+void
+LoadDatabaseCompletion(struct mpdclient &c, const char *path) noexcept;
+
+/**
+ * Returns the list of stored playlist names (in the locale charset)
+ * for completion.  Like GetDatabaseCompletionList(), it persists
+ * across prompts.
+ */
+PathTrie &
+GetPlaylistCompletionList(struct mpdclient &c) noexcept;
 
 /**
- * Create a list suitable for #Completion from path.
+ * Fill the playlist completion list, unless that has already been
+ * done.
  */
 void
-gcmp_list_from_path(struct mpdclient *c, const char *path,
-		    Completion &completion,
-		    int types);
+LoadPlaylistCompletion(struct mpdclient &c) noexcept;
 
 #endif
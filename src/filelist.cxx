@@ -18,6 +18,10 @@
  */
 
 #include "filelist.hxx"
+#include "ListDiff.hxx"
+#include "SortKey.hxx"
+#include "UriSet.hxx"
+#include "PerfStats.hxx"
 #include "util/StringUTF8.hxx"
 
 #include <mpd/client.h>
@@ -33,6 +37,30 @@ FileListEntry::~FileListEntry()
 		mpd_entity_free(entity);
 }
 
+void
+FileListEntry::Load(struct mpd_entity *_entity) noexcept
+{
+	assert(_entity != nullptr);
+
+	if (entity != nullptr)
+		mpd_entity_free(entity);
+
+	entity = _entity;
+	flags &= ~PLACEHOLDER;
+}
+
+void
+FileListEntry::Unload() noexcept
+{
+	if (entity != nullptr) {
+		mpd_entity_free(entity);
+		entity = nullptr;
+	}
+
+	/* keep the other flags, e.g. the user's selection */
+	flags |= PLACEHOLDER;
+}
+
 gcc_pure
 static bool
 Less(const struct mpd_entity &a, struct mpd_entity &b)
@@ -79,13 +107,27 @@ FileListEntry::operator<(const FileListEntry &other) const
 	return Less(entity, other.entity);
 }
 
+FileList::~FileList() noexcept
+{
+	perf_stats.file_list_entries -= entries.size();
+}
+
 FileListEntry &
 FileList::emplace_back(struct mpd_entity *entity)
 {
 	entries.emplace_back(entity);
+	++perf_stats.file_list_entries;
 	return entries.back();
 }
 
+void
+FileList::AppendPlaceholders(size_type n)
+{
+	entries.reserve(size() + n);
+	for (size_type i = 0; i < n; ++i)
+		emplace_back(nullptr).flags = FileListEntry::PLACEHOLDER;
+}
+
 void
 FileList::MoveFrom(FileList &&src)
 {
@@ -95,26 +137,52 @@ FileList::MoveFrom(FileList &&src)
 	src.entries.clear();
 }
 
-void
-FileList::Sort()
+/**
+ * Calculate a key which sorts like Less(): by entity type, then
+ * directories and playlists by name; songs retain their order.
+ */
+static std::string
+MakeEntitySortKey(const struct mpd_entity *entity) noexcept
 {
-	std::stable_sort(entries.begin(), entries.end());
+	if (entity == nullptr)
+		/* the ".." entry */
+		return {};
+
+	const auto type = mpd_entity_get_type(entity);
+	std::string key(1, char(1 + type));
+
+	switch (type) {
+	case MPD_ENTITY_TYPE_UNKNOWN:
+	case MPD_ENTITY_TYPE_SONG:
+		break;
+
+	case MPD_ENTITY_TYPE_DIRECTORY:
+		key += MakeSortKey(mpd_directory_get_path(mpd_entity_get_directory(entity)));
+		break;
+
+	case MPD_ENTITY_TYPE_PLAYLIST:
+		key += MakeSortKey(mpd_playlist_get_path(mpd_entity_get_playlist(entity)));
+		break;
+	}
+
+	return key;
 }
 
 void
-FileList::RemoveDuplicateSongs()
+FileList::Sort()
 {
-	for (int i = size() - 1; i >= 0; --i) {
-		auto &entry = (*this)[i];
+	/* calculate each sort key once instead of collating in each
+	   comparison */
+	const auto order = SortByKeys(size(), [this](size_t i){
+			return MakeEntitySortKey(entries[i].entity);
+		});
 
-		if (entry.entity == nullptr ||
-		    mpd_entity_get_type(entry.entity) != MPD_ENTITY_TYPE_SONG)
-			continue;
+	Vector sorted;
+	sorted.reserve(size());
+	for (unsigned i : order)
+		sorted.emplace_back(std::move(entries[i]));
 
-		const auto *song = mpd_entity_get_song(entry.entity);
-		if (FindSong(*song) < i)
-			entries.erase(std::next(entries.begin(), i));
-	}
+	entries = std::move(sorted);
 }
 
 static bool
@@ -165,14 +233,74 @@ FileList::Receive(struct mpd_connection &connection)
 {
 	struct mpd_entity *entity;
 
-	while ((entity = mpd_recv_entity(&connection)) != nullptr)
+	while ((entity = mpd_recv_entity(&connection)) != nullptr) {
+		++perf_stats.entities_received;
 		emplace_back(entity);
+	}
 }
 
-FileList *
-filelist_new_recv(struct mpd_connection *connection)
+/**
+ * Returns the path which identifies the entity within its list.
+ */
+gcc_pure
+static const char *
+GetEntityPath(const struct mpd_entity *entity) noexcept
 {
-	auto *filelist = new FileList();
-	filelist->Receive(*connection);
-	return filelist;
+	if (entity == nullptr)
+		/* the ".." entry */
+		return "";
+
+	switch (mpd_entity_get_type(entity)) {
+	case MPD_ENTITY_TYPE_UNKNOWN:
+		break;
+
+	case MPD_ENTITY_TYPE_DIRECTORY:
+		return mpd_directory_get_path(mpd_entity_get_directory(entity));
+
+	case MPD_ENTITY_TYPE_SONG:
+		return mpd_song_get_uri(mpd_entity_get_song(entity));
+
+	case MPD_ENTITY_TYPE_PLAYLIST:
+		return mpd_playlist_get_path(mpd_entity_get_playlist(entity));
+	}
+
+	return "";
+}
+
+gcc_pure
+static bool
+SameEntity(const struct mpd_entity *a, const struct mpd_entity *b) noexcept
+{
+	if (a == nullptr || b == nullptr)
+		return a == b;
+
+	return mpd_entity_get_type(a) == mpd_entity_get_type(b) &&
+		strcmp(GetEntityPath(a), GetEntityPath(b)) == 0;
+}
+
+static UriSet
+CollectPaths(const FileList &list) noexcept
+{
+	UriSet paths;
+	paths.reserve(list.size());
+	for (unsigned i = 0; i < list.size(); ++i)
+		paths.emplace(GetEntityPath(list[i].entity));
+	return paths;
+}
+
+ListDiff
+DiffFileLists(const FileList &a, const FileList &b) noexcept
+{
+	const auto a_paths = CollectPaths(a), b_paths = CollectPaths(b);
+
+	return DiffLists(a.size(), b.size(),
+			 [&a, &b](unsigned i, unsigned j){
+				 return SameEntity(a[i].entity, b[j].entity);
+			 },
+			 [&a, &b_paths](unsigned i){
+				 return b_paths.find(GetEntityPath(a[i].entity)) != b_paths.end();
+			 },
+			 [&b, &a_paths](unsigned j){
+				 return a_paths.find(GetEntityPath(b[j].entity)) != a_paths.end();
+			 });
 }
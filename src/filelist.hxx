@@ -27,8 +27,15 @@
 
 struct mpd_connection;
 struct mpd_song;
+struct ListDiff;
 
 struct FileListEntry {
+	/**
+	 * A flag for #flags: this entry is a placeholder for an item
+	 * which has not been loaded yet.
+	 */
+	static constexpr unsigned PLACEHOLDER = 0x8000;
+
 	unsigned flags = 0;
 	struct mpd_entity *entity;
 
@@ -49,6 +56,28 @@ struct FileListEntry {
 
 	gcc_pure
 	bool operator<(const FileListEntry &other) const;
+
+	bool IsPlaceholder() const noexcept {
+		return (flags & PLACEHOLDER) != 0;
+	}
+
+	/**
+	 * Is this the ".." entry?  Placeholders have no entity
+	 * either, but they are not "..".
+	 */
+	bool IsParent() const noexcept {
+		return entity == nullptr && !IsPlaceholder();
+	}
+
+	/**
+	 * Fill a placeholder with the loaded entity.
+	 */
+	void Load(struct mpd_entity *_entity) noexcept;
+
+	/**
+	 * Free the entity and turn this entry into a placeholder.
+	 */
+	void Unload() noexcept;
 };
 
 class FileList {
@@ -61,6 +90,7 @@ public:
 	using size_type = Vector::size_type;
 
 	FileList() = default;
+	~FileList() noexcept;
 
 	FileList(const FileList &) = delete;
 	FileList &operator=(const FileList &) = delete;
@@ -83,6 +113,11 @@ public:
 
 	FileListEntry &emplace_back(struct mpd_entity *entity);
 
+	/**
+	 * Append placeholders for items which will be loaded later.
+	 */
+	void AppendPlaceholders(size_type n);
+
 	void MoveFrom(FileList &&src);
 
 	/**
@@ -90,11 +125,6 @@ public:
 	 */
 	void Sort();
 
-	/**
-	 * Eliminates duplicate songs from the FileList.
-	 */
-	void RemoveDuplicateSongs();
-
 	gcc_pure
 	int FindSong(const struct mpd_song &song) const;
 
@@ -110,10 +140,11 @@ public:
 };
 
 /**
- * Creates a new FileList and receives entities from the connection.
- * This does not finish the response, and does not check for errors.
+ * Compare two versions of a #FileList, e.g. before and after a
+ * database update.  Entries are identified by their path.
  */
-FileList *
-filelist_new_recv(struct mpd_connection *connection);
+gcc_pure
+ListDiff
+DiffFileLists(const FileList &a, const FileList &b) noexcept;
 
 #endif
@@ -35,6 +35,10 @@
 
 #include <boost/asio/posix/stream_descriptor.hpp>
 
+#include <utility>
+
+#include <assert.h>
+
 class MpdIdleHandler {
 public:
 	virtual void OnIdle(unsigned events) noexcept = 0;
@@ -75,6 +79,27 @@ public:
 	 */
 	void Leave() noexcept;
 
+	/**
+	 * Invoke the given handler as soon as the response to a
+	 * command sent outside of idle mode begins to arrive, so it
+	 * can be received without blocking on the round trip.
+	 */
+	template<typename H>
+	void AsyncWaitResponse(H &&response_handler) noexcept {
+		assert(io_events == 0);
+
+		socket.async_read_some(boost::asio::null_buffers(),
+				       std::forward<H>(response_handler));
+	}
+
+	/**
+	 * Cancel AsyncWaitResponse().
+	 */
+	void CancelWaitResponse() noexcept {
+		if (io_events == 0)
+			socket.cancel();
+	}
+
 private:
 	void InvokeCallback() noexcept {
 		if (idle_events != 0)
@@ -22,10 +22,16 @@
 #include "config.h"
 #include "gidle.hxx"
 #include "charset.hxx"
+#include "QueueSort.hxx"
 
 #include <mpd/client.h>
 
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
 #include <assert.h>
+#include <string.h>
 
 void
 mpdclient::OnEnterIdleTimer(const boost::system::error_code &error) noexcept
@@ -36,6 +42,26 @@ mpdclient::OnEnterIdleTimer(const boost::system::error_code &error) noexcept
 	assert(source != nullptr);
 	assert(!idle);
 
+	if (receiving_entities)
+		/* the connection is busy; ReceiveEntities() will
+		   schedule this timer again when the response is
+		   complete */
+		return;
+
+	if (pending_edit.IsDefined() && !FinishQueueEdit()) {
+		/* the edit was rolled back; show the restored
+		   queue */
+		if (source == nullptr)
+			return;
+
+		mpdclient_idle_callback(events);
+		events = 0;
+
+		if (source != nullptr)
+			ScheduleEnterIdle();
+		return;
+	}
+
 	idle = source->Enter();
 }
 
@@ -74,14 +100,75 @@ mpdclient::InvokeErrorCallback() noexcept
 					mpd_connection_get_error_message(connection));
 }
 
+/**
+ * Idle events which arrive within this duration after the previous
+ * one open a coalescing window.
+ */
+static constexpr std::chrono::steady_clock::duration IDLE_BURST_THRESHOLD =
+	std::chrono::milliseconds(100);
+
+static constexpr std::chrono::steady_clock::duration IDLE_BURST_MIN_WINDOW =
+	std::chrono::milliseconds(100);
+
+static constexpr std::chrono::steady_clock::duration IDLE_BURST_MAX_WINDOW =
+	std::chrono::seconds(1);
+
 void
-mpdclient::OnIdle(unsigned _events) noexcept
+mpdclient::ScheduleIdleBurstTimer() noexcept
 {
-	assert(IsConnected());
+	idle_burst_pending = true;
 
-	idle = false;
+	boost::system::error_code error;
+	idle_burst_timer.expires_from_now(idle_burst_window, error);
+	idle_burst_timer.async_wait(std::bind(&mpdclient::OnIdleBurstTimer,
+					      this, std::placeholders::_1));
+}
+
+void
+mpdclient::CancelIdleBurstTimer() noexcept
+{
+	if (idle_burst_pending) {
+		idle_burst_pending = false;
+		idle_burst_timer.cancel();
+	}
+
+	burst_events = 0;
+	idle_burst_window = IDLE_BURST_MIN_WINDOW;
+}
+
+void
+mpdclient::OnIdleBurstTimer(const boost::system::error_code &error) noexcept
+{
+	if (error)
+		return;
+
+	assert(idle_burst_pending);
+	/* the timer is only armed after an event was coalesced in
+	   this window */
+	assert(burst_events != 0);
+
+	/* leave idle mode first; events received meanwhile are
+	   merged into this window */
+	if (GetConnection() == nullptr)
+		return;
+
+	idle_burst_pending = false;
+
+	if (std::chrono::steady_clock::now() - last_idle_time < IDLE_BURST_THRESHOLD)
+		/* the burst continues; the next window will be
+		   longer */
+		idle_burst_window = std::min<std::chrono::steady_clock::duration>(idle_burst_window * 2,
+										  IDLE_BURST_MAX_WINDOW);
+
+	events |= std::exchange(burst_events, 0);
+	HandleIdleEvents();
+}
+
+void
+mpdclient::HandleIdleEvents() noexcept
+{
+	++idle_statistics.handled;
 
-	events |= _events;
 	Update();
 
 	mpdclient_idle_callback(events);
@@ -91,6 +178,47 @@ mpdclient::OnIdle(unsigned _events) noexcept
 		ScheduleEnterIdle();
 }
 
+void
+mpdclient::OnIdle(unsigned _events) noexcept
+{
+	assert(IsConnected());
+
+	idle = false;
+
+	++idle_statistics.received;
+
+	if (_events & (MPD_IDLE_DATABASE | MPD_IDLE_STORED_PLAYLIST))
+		++database_serial;
+
+	const auto now = std::chrono::steady_clock::now();
+	const bool burst = now - last_idle_time < IDLE_BURST_THRESHOLD;
+	last_idle_time = now;
+
+	if (idle_burst_pending || burst) {
+		/* events are arriving faster than we should handle
+		   them: collect them and handle them all at once
+		   when the window closes */
+		burst_events |= _events;
+		++idle_statistics.coalesced;
+
+		if (!idle_burst_pending) {
+			++idle_statistics.windows;
+			ScheduleIdleBurstTimer();
+		}
+
+		if (source != nullptr)
+			ScheduleEnterIdle();
+		return;
+	}
+
+	/* a quiet period: start the next burst with the shortest
+	   window */
+	idle_burst_window = IDLE_BURST_MIN_WINDOW;
+
+	events |= _events;
+	HandleIdleEvents();
+}
+
 void
 mpdclient::OnIdleError(enum mpd_error error,
 		       gcc_unused enum mpd_server_error server_error,
@@ -158,7 +286,10 @@ mpdclient::mpdclient(boost::asio::io_service &io_service,
 #if BOOST_VERSION >= 107000
 	 io_context(io_service),
 #endif
-	 enter_idle_timer(io_service)
+	 enter_idle_timer(io_service),
+	 idle_burst_timer(io_service),
+	 receive_entities_timer(io_service),
+	 idle_burst_window(IDLE_BURST_MIN_WINDOW)
 {
 #ifdef ENABLE_ASYNC_CONNECT
 	settings = mpd_settings_new(_host, _port, _timeout_ms,
@@ -258,6 +389,16 @@ mpdclient::Disconnect()
 #endif
 
 	CancelEnterIdle();
+	CancelIdleBurstTimer();
+
+	if (receiving_entities) {
+		receive_entities_timer.cancel();
+		receiving_entities = false;
+
+		auto *handler = std::exchange(entity_handler, nullptr);
+		if (handler != nullptr)
+			handler->OnEntityEnd(false);
+	}
 
 	delete source;
 	source = nullptr;
@@ -271,6 +412,7 @@ mpdclient::Disconnect()
 
 	ClearStatus();
 
+	pending_edit.Clear();
 	playlist.clear();
 
 	current_song = nullptr;
@@ -428,6 +570,12 @@ mpdclient::Connect()
 bool
 mpdclient::Update()
 {
+	if (receiving_entities)
+		/* don't interrupt a response which is being received
+		   in portions; the status will be updated after it
+		   has completed */
+		return true;
+
 	auto *c = GetConnection();
 
 	if (c == nullptr)
@@ -438,6 +586,7 @@ mpdclient::Update()
 
 	/* retrieve new status */
 	status = mpd_run_status(c);
+	RecordCommandLatency(perf_stats.status_latency);
 	if (status == nullptr)
 		return HandleError();
 
@@ -466,9 +615,157 @@ mpdclient::Update()
 	return true;
 }
 
+/**
+ * The number of entities received in one main loop iteration by
+ * ReceiveEntitiesAsync().
+ */
+static constexpr unsigned ENTITY_PORTION_SIZE = 512;
+
+void
+mpdclient::ReceiveEntitiesAsync(MpdEntityHandler &handler) noexcept
+{
+	assert(connection != nullptr);
+	assert(!receiving_entities);
+
+	entity_handler = &handler;
+	receiving_entities = true;
+
+	/* don't enter idle mode before the response is complete */
+	CancelEnterIdle();
+
+	if (source != nullptr)
+		/* don't block the main loop during the round trip:
+		   receive the first portion only after the response
+		   has begun to arrive */
+		source->AsyncWaitResponse(std::bind(&mpdclient::OnReceiveEntitiesTimer,
+						    this,
+						    std::placeholders::_1));
+	else
+		ScheduleReceiveEntities();
+}
+
+gcc_pure
+static bool
+IsEntityStart(const struct mpd_pair &pair) noexcept
+{
+	return strcmp(pair.name, "file") == 0 ||
+		strcmp(pair.name, "directory") == 0 ||
+		strcmp(pair.name, "playlist") == 0;
+}
+
+/**
+ * Like mpd_recv_entity(), but let the handler decide whether the
+ * entity is wanted before allocating it.  Unwanted entities (and all
+ * entities if there is no handler) are skipped.
+ *
+ * @return false at the end of the response or on error
+ */
+static bool
+ReceiveEntity(struct mpd_connection &connection,
+	      MpdEntityHandler *handler) noexcept
+{
+	auto *pair = mpd_recv_pair(&connection);
+	if (pair == nullptr)
+		return false;
+
+	if (handler == nullptr || !handler->AcceptEntity(*pair)) {
+		/* skip all pairs up to the next entity */
+		do {
+			mpd_return_pair(&connection, pair);
+			pair = mpd_recv_pair(&connection);
+		} while (pair != nullptr && !IsEntityStart(*pair));
+
+		if (mpd_connection_get_error(&connection) != MPD_ERROR_SUCCESS)
+			return false;
+
+		/* unread this pair for the next call */
+		mpd_enqueue_pair(&connection, pair);
+		return true;
+	}
+
+	auto *entity = mpd_entity_begin(pair);
+	mpd_return_pair(&connection, pair);
+	if (entity == nullptr)
+		return false;
+
+	while ((pair = mpd_recv_pair(&connection)) != nullptr &&
+	       mpd_entity_feed(entity, pair))
+		mpd_return_pair(&connection, pair);
+
+	if (mpd_connection_get_error(&connection) != MPD_ERROR_SUCCESS) {
+		mpd_entity_free(entity);
+		return false;
+	}
+
+	mpd_enqueue_pair(&connection, pair);
+
+	++perf_stats.entities_received;
+	handler->OnEntity(*entity);
+	return true;
+}
+
+bool
+mpdclient::ReceiveEntities(unsigned max) noexcept
+{
+	assert(receiving_entities);
+
+	for (unsigned n = 0; max == 0 || n < max; ++n) {
+		if (!ReceiveEntity(*connection, entity_handler)) {
+			/* end of response (or error) */
+			receiving_entities = false;
+			auto *handler = std::exchange(entity_handler, nullptr);
+
+			const bool success = FinishCommand();
+			if (handler != nullptr)
+				handler->OnEntityEnd(success);
+
+			if (source != nullptr)
+				ScheduleEnterIdle();
+			return true;
+		}
+	}
+
+	if (entity_handler != nullptr)
+		entity_handler->OnEntityPortion();
+
+	return false;
+}
+
+void
+mpdclient::ScheduleReceiveEntities() noexcept
+{
+	/* receive the next portion after pending input has been
+	   handled */
+	boost::system::error_code error;
+	receive_entities_timer.expires_from_now(std::chrono::seconds(0),
+						error);
+	receive_entities_timer.async_wait(std::bind(&mpdclient::OnReceiveEntitiesTimer,
+						    this,
+						    std::placeholders::_1));
+}
+
+void
+mpdclient::OnReceiveEntitiesTimer(const boost::system::error_code &error) noexcept
+{
+	if (error || !receiving_entities)
+		return;
+
+	if (!ReceiveEntities(ENTITY_PORTION_SIZE))
+		ScheduleReceiveEntities();
+}
+
 struct mpd_connection *
 mpdclient::GetConnection()
 {
+	if (receiving_entities) {
+		/* the connection is still busy with an entity
+		   response; receive the rest of it now */
+		receive_entities_timer.cancel();
+		if (source != nullptr)
+			source->CancelWaitResponse();
+		ReceiveEntities(0);
+	}
+
 	if (source != nullptr && idle) {
 		idle = false;
 		source->Leave();
@@ -477,6 +774,12 @@ mpdclient::GetConnection()
 			ScheduleEnterIdle();
 	}
 
+	if (pending_edit.IsDefined())
+		FinishQueueEdit();
+
+	if (perf_stats.enabled && connection != nullptr)
+		command_start = std::chrono::steady_clock::now();
+
 	return connection;
 }
 
@@ -576,24 +879,6 @@ mpdclient::RunVolume(unsigned value) noexcept
 	return FinishCommand();
 }
 
-bool
-mpdclient::RunVolumeUp() noexcept
-{
-	if (volume < 0 || volume >= 100)
-		return true;
-
-	return RunVolume(++volume);
-}
-
-bool
-mpdclient::RunVolumeDown() noexcept
-{
-	if (volume <= 0)
-		return true;
-
-	return RunVolume(--volume);
-}
-
 bool
 mpdclient_cmd_add_path(struct mpdclient *c, const char *path_utf8)
 {
@@ -616,191 +901,368 @@ mpdclient::RunAdd(const struct mpd_song &song) noexcept
 	   status (to verify the new playlist id) and the last song
 	   (we hope that's the song we just added) */
 
+	const unsigned position = playlist.size();
+
 	if (!mpd_command_list_begin(c, true) ||
 	    !mpd_send_add(c, mpd_song_get_uri(&song)) ||
 	    !mpd_send_status(c) ||
-	    !mpd_send_get_queue_song_pos(c, playlist.size()) ||
-	    !mpd_command_list_end(c) ||
-	    !mpd_response_next(c))
+	    !mpd_send_get_queue_song_pos(c, position) ||
+	    !mpd_command_list_end(c))
 		return HandleError();
 
 	events |= MPD_IDLE_QUEUE;
 
-	const struct mpd_status *new_status = ReceiveStatus();
-	if (new_status == nullptr)
-		return false;
-
-	if (!mpd_response_next(c))
-		return HandleError();
-
-	struct mpd_song *new_song = mpd_recv_song(c);
-	if (!mpd_response_finish(c) || new_song == nullptr) {
-		if (new_song != nullptr)
-			mpd_song_free(new_song);
-
-		return mpd_connection_clear_error(c) ||
-			HandleError();
-	}
-
-	if (mpd_status_get_queue_length(new_status) == playlist.size() + 1 &&
-	    mpd_status_get_queue_version(new_status) == playlist.version + 1) {
-		/* the cheap route: match on the new playlist length
-		   and its version, we can keep our local playlist
-		   copy in sync */
-		playlist.version = mpd_status_get_queue_version(new_status);
-
-		/* the song we just received has the correct id;
-		   append it to the local playlist */
-		playlist.push_back(*new_song);
-	}
+	/* append a copy of the song to the local playlist right now;
+	   it will be replaced with the song returned by MPD (which
+	   has the correct id) in FinishQueueEdit() */
+	playlist.push_back(song);
 
-	mpd_song_free(new_song);
+	pending_edit.type = PendingQueueEdit::Type::ADD;
+	pending_edit.position = position;
+	pending_edit.expected_length = position + 1;
+	pending_edit.expected_version = playlist.version + 1;
 
 	return true;
 }
 
 bool
 mpdclient::RunDelete(unsigned pos) noexcept
+{
+	return RunDeleteRange(pos, pos + 1);
+}
+
+bool
+mpdclient::RunDeleteRange(unsigned start, unsigned end) noexcept
 {
 	auto *c = GetConnection();
 	if (c == nullptr || status == nullptr)
 		return false;
 
-	if (pos >= playlist.size())
+	if (start >= end || end > playlist.size())
 		return false;
 
-	const auto &song = playlist[pos];
-
 	/* send the delete command to mpd; at the same time, get the
 	   new status (to verify the playlist id) */
 
 	if (!mpd_command_list_begin(c, false) ||
-	    !mpd_send_delete_id(c, mpd_song_get_id(&song)) ||
+	    /* if that's not really a range, we choose to use the
+	       safer "deleteid" version */
+	    !(end == start + 1
+	      ? mpd_send_delete_id(c, mpd_song_get_id(&playlist[start]))
+	      : mpd_send_delete_range(c, start, end)) ||
 	    !mpd_send_status(c) ||
 	    !mpd_command_list_end(c))
 		return HandleError();
 
 	events |= MPD_IDLE_QUEUE;
 
-	const struct mpd_status *new_status = ReceiveStatus();
-	if (new_status == nullptr)
-		return false;
-
-	if (!mpd_response_finish(c))
-		return HandleError();
-
-	if (mpd_status_get_queue_length(new_status) == playlist.size() - 1 &&
-	    mpd_status_get_queue_version(new_status) == playlist.version + 1) {
-		/* the cheap route: match on the new playlist length
-		   and its version, we can keep our local playlist
-		   copy in sync */
-		playlist.version = mpd_status_get_queue_version(new_status);
-
-		/* remove the song from the local playlist */
-		playlist.RemoveIndex(pos);
-
-		/* remove references to the song */
-		if (current_song == &song)
+	/* remove references to the songs */
+	for (unsigned i = start; i < end; ++i) {
+		if (current_song == &playlist[i]) {
 			current_song = nullptr;
+			break;
+		}
 	}
 
+	/* remove the songs from the local playlist, but keep them
+	   until MPD has confirmed the deletion */
+	pending_edit.type = PendingQueueEdit::Type::DELETE;
+	pending_edit.position = start;
+	pending_edit.expected_length = playlist.size() - (end - start);
+	pending_edit.expected_version = playlist.version + 1;
+	playlist.TakeRange(start, end, pending_edit.removed);
+
 	return true;
 }
 
 bool
-mpdclient::RunDeleteRange(unsigned start, unsigned end) noexcept
+mpdclient::RunMove(unsigned dest_pos, unsigned src_pos) noexcept
 {
-	if (end == start + 1)
-		/* if that's not really a range, we choose to use the
-		   safer "deleteid" version */
-		return RunDelete(start);
+	if (dest_pos == src_pos)
+		return true;
 
 	auto *c = GetConnection();
 	if (c == nullptr)
 		return false;
 
-	/* send the delete command to mpd; at the same time, get the
+	if (src_pos >= playlist.size() || dest_pos >= playlist.size())
+		return false;
+
+	/* send the "move" command to MPD; at the same time, get the
 	   new status (to verify the playlist id) */
 
 	if (!mpd_command_list_begin(c, false) ||
-	    !mpd_send_delete_range(c, start, end) ||
+	    !mpd_send_move(c, src_pos, dest_pos) ||
 	    !mpd_send_status(c) ||
 	    !mpd_command_list_end(c))
 		return HandleError();
 
 	events |= MPD_IDLE_QUEUE;
 
-	const struct mpd_status *new_status = ReceiveStatus();
-	if (new_status == nullptr)
-		return false;
-
-	if (!mpd_response_finish(c))
-		return HandleError();
-
-	if (mpd_status_get_queue_length(new_status) == playlist.size() - (end - start) &&
-	    mpd_status_get_queue_version(new_status) == playlist.version + 1) {
-		/* the cheap route: match on the new playlist length
-		   and its version, we can keep our local playlist
-		   copy in sync */
-		playlist.version = mpd_status_get_queue_version(new_status);
-
-		/* remove the song from the local playlist */
-		while (end > start) {
-			--end;
+	/* swap songs in the local playlist */
+	playlist.Move(dest_pos, src_pos);
 
-			/* remove references to the song */
-			if (current_song == &playlist[end])
-				current_song = nullptr;
-
-			playlist.RemoveIndex(end);
-		}
-	}
+	pending_edit.type = PendingQueueEdit::Type::MOVE;
+	pending_edit.position = src_pos;
+	pending_edit.dest = dest_pos;
+	pending_edit.expected_length = playlist.size();
+	pending_edit.expected_version = playlist.version + 1;
 
 	return true;
 }
 
 bool
-mpdclient::RunMove(unsigned dest_pos, unsigned src_pos) noexcept
+mpdclient::RunReorder(unsigned start,
+		      const std::vector<unsigned> &order) noexcept
 {
-	if (dest_pos == src_pos)
+	assert(start + order.size() <= playlist.size());
+
+	const auto moves = PlanQueueMoves(order);
+	if (moves.empty())
 		return true;
 
 	auto *c = GetConnection();
 	if (c == nullptr)
 		return false;
 
-	/* send the "move" command to MPD; at the same time, get the
-	   new status (to verify the playlist id) */
+	/* send all "move" commands in one command list, followed by
+	   "status" */
 
-	if (!mpd_command_list_begin(c, false) ||
-	    !mpd_send_move(c, src_pos, dest_pos) ||
-	    !mpd_send_status(c) ||
+	if (!mpd_command_list_begin(c, false))
+		return HandleError();
+
+	for (const auto &i : moves) {
+		if (!(i.end == i.start + 1
+		      ? mpd_send_move(c, start + i.start, start + i.to)
+		      : mpd_send_move_range(c, start + i.start,
+					    start + i.end,
+					    start + i.to)))
+			return HandleError();
+	}
+
+	if (!mpd_send_status(c) ||
 	    !mpd_command_list_end(c))
 		return HandleError();
 
 	events |= MPD_IDLE_QUEUE;
 
-	const struct mpd_status *new_status = ReceiveStatus();
-	if (status == nullptr)
+	playlist.Reorder(start, order);
+
+	/* MPD increments the queue version for each command */
+	pending_edit.type = PendingQueueEdit::Type::REORDER;
+	pending_edit.position = start;
+	pending_edit.order = order;
+	pending_edit.expected_length = playlist.size();
+	pending_edit.expected_version = playlist.version + moves.size();
+
+	return true;
+}
+
+int
+mpdclient::RunDeleteDuplicates() noexcept
+{
+	auto *c = GetConnection();
+	if (c == nullptr || status == nullptr)
+		return -1;
+
+	auto duplicates = playlist.FindDuplicates(playing_or_paused
+						  ? GetCurrentSongPos()
+						  : -1);
+	if (duplicates.empty())
+		return 0;
+
+	/* send one command for each range of adjacent duplicates,
+	   starting at the end of the queue so the positions of the
+	   remaining ranges are not affected */
+
+	if (!mpd_command_list_begin(c, false)) {
+		HandleError();
+		return -1;
+	}
+
+	unsigned n_commands = 0;
+	for (auto end = duplicates.size(); end > 0;) {
+		auto start = end - 1;
+		while (start > 0 &&
+		       duplicates[start - 1] + 1 == duplicates[start])
+			--start;
+
+		const unsigned start_pos = duplicates[start];
+		const unsigned end_pos = duplicates[end - 1] + 1;
+
+		if (!(end_pos == start_pos + 1
+		      ? mpd_send_delete_id(c, mpd_song_get_id(&playlist[start_pos]))
+		      : mpd_send_delete_range(c, start_pos, end_pos))) {
+			HandleError();
+			return -1;
+		}
+
+		++n_commands;
+		end = start;
+	}
+
+	if (!mpd_send_status(c) ||
+	    !mpd_command_list_end(c)) {
+		HandleError();
+		return -1;
+	}
+
+	events |= MPD_IDLE_QUEUE;
+
+	pending_edit.type = PendingQueueEdit::Type::DELETE_LIST;
+	pending_edit.expected_length = playlist.size() - duplicates.size();
+	pending_edit.expected_version = playlist.version + n_commands;
+
+	/* remove the songs from the local playlist, but keep them
+	   until MPD has confirmed the deletion */
+	std::vector<MpdQueue::Item> removed;
+	for (auto i = duplicates.rbegin(); i != duplicates.rend(); ++i) {
+		if (current_song == &playlist[*i])
+			current_song = nullptr;
+
+		playlist.TakeRange(*i, *i + 1, removed);
+	}
+
+	/* "removed" is in descending order; store it ascending,
+	   matching the order of positions in "duplicates" */
+	std::move(removed.rbegin(), removed.rend(),
+		  std::back_inserter(pending_edit.removed));
+
+	const int n = duplicates.size();
+	pending_edit.order = std::move(duplicates);
+	return n;
+}
+
+bool
+mpdclient::FinishQueueEdit() noexcept
+{
+	assert(pending_edit.IsDefined());
+	assert(connection != nullptr);
+
+	auto *c = connection;
+
+	PendingQueueEdit edit = std::move(pending_edit);
+	pending_edit.Clear();
+
+	if (edit.type == PendingQueueEdit::Type::ADD &&
+	    !mpd_response_next(c)) {
+		RollbackQueueEdit(edit);
+		HandleError();
 		return false;
+	}
 
-	if (!mpd_response_finish(c))
-		return HandleError();
+	struct mpd_status *new_status = mpd_recv_status(c);
+	if (new_status == nullptr) {
+		RollbackQueueEdit(edit);
+		HandleError();
+		return false;
+	}
+
+	if (status != nullptr)
+		mpd_status_free(status);
+	status = new_status;
 
-	if (mpd_status_get_queue_length(new_status) == playlist.size() &&
-	    mpd_status_get_queue_version(new_status) == playlist.version + 1) {
+	struct mpd_song *new_song = nullptr;
+	if (edit.type == PendingQueueEdit::Type::ADD) {
+		if (!mpd_response_next(c)) {
+			RollbackQueueEdit(edit);
+			HandleError();
+			return false;
+		}
+
+		new_song = mpd_recv_song(c);
+	}
+
+	if (!mpd_response_finish(c)) {
+		if (new_song != nullptr)
+			mpd_song_free(new_song);
+
+		RollbackQueueEdit(edit);
+		HandleError();
+		return false;
+	}
+
+	if (mpd_status_get_queue_length(new_status) == edit.expected_length &&
+	    mpd_status_get_queue_version(new_status) == edit.expected_version &&
+	    (edit.type != PendingQueueEdit::Type::ADD || new_song != nullptr)) {
 		/* the cheap route: match on the new playlist length
-		   and its version, we can keep our local playlist
-		   copy in sync */
+		   and its version, our local playlist copy is in
+		   sync */
 		playlist.version = mpd_status_get_queue_version(new_status);
 
-		/* swap songs in the local playlist */
-		playlist.Move(dest_pos, src_pos);
+		if (new_song != nullptr)
+			/* the song we just received has the correct
+			   id; replace the local copy */
+			playlist.Replace(edit.position, *new_song);
 	}
 
+	/* if another client has modified the queue concurrently,
+	   the local playlist version remains unchanged, and the next
+	   Update() will fix up the local copy with "plchanges" */
+
+	if (new_song != nullptr)
+		mpd_song_free(new_song);
+
 	return true;
 }
 
+void
+mpdclient::RollbackQueueEdit(PendingQueueEdit &edit) noexcept
+{
+	switch (edit.type) {
+	case PendingQueueEdit::Type::NONE:
+		assert(false);
+		gcc_unreachable();
+
+	case PendingQueueEdit::Type::ADD:
+		if (current_song == &playlist[edit.position])
+			current_song = nullptr;
+
+		playlist.RemoveIndex(edit.position);
+		break;
+
+	case PendingQueueEdit::Type::DELETE:
+		for (auto &i : edit.removed)
+			playlist.Insert(edit.position++, std::move(i));
+		break;
+
+	case PendingQueueEdit::Type::MOVE:
+		playlist.Move(edit.position, edit.dest);
+		break;
+
+	case PendingQueueEdit::Type::REORDER:
+		{
+			std::vector<unsigned> inverse(edit.order.size());
+			for (unsigned i = 0; i < edit.order.size(); ++i)
+				inverse[edit.order[i]] = i;
+
+			playlist.Reorder(edit.position, inverse);
+		}
+
+		/* some of the "move" commands may have succeeded;
+		   force a full reload of the queue */
+		playlist.version = 0;
+		break;
+
+	case PendingQueueEdit::Type::DELETE_LIST:
+		/* re-insert in ascending order, so each position
+		   refers to the restored queue */
+		for (unsigned i = 0; i < edit.order.size(); ++i)
+			playlist.Insert(edit.order[i],
+					std::move(edit.removed[i]));
+
+		/* some of the "delete" commands may have succeeded;
+		   force a full reload of the queue */
+		playlist.version = 0;
+		break;
+	}
+
+	if (current_song == nullptr && status != nullptr)
+		current_song = playlist.GetChecked(mpd_status_get_song_pos(status));
+
+	events |= MPD_IDLE_QUEUE;
+}
+
 /* The client-to-client protocol (MPD 0.17.0) */
 
 bool
@@ -862,6 +1324,8 @@ mpdclient::UpdateQueue()
 
 	struct mpd_entity *entity;
 	while ((entity = mpd_recv_entity(c))) {
+		++perf_stats.entities_received;
+
 		if (mpd_entity_get_type(entity) == MPD_ENTITY_TYPE_SONG)
 			playlist.push_back(*mpd_entity_get_song(entity));
 
@@ -871,7 +1335,7 @@ mpdclient::UpdateQueue()
 	playlist.version = mpd_status_get_queue_version(status);
 	current_song = nullptr;
 
-	return FinishCommand();
+	return FinishCommand(perf_stats.queue_latency);
 }
 
 /* update playlist (plchanges) */
@@ -886,6 +1350,8 @@ mpdclient::UpdateQueueChanges()
 
 	struct mpd_song *s;
 	while ((s = mpd_recv_song(c)) != nullptr) {
+		++perf_stats.entities_received;
+
 		int pos = mpd_song_get_pos(s);
 
 		if (pos >= 0 && (unsigned)pos < playlist.size()) {
@@ -902,13 +1368,11 @@ mpdclient::UpdateQueueChanges()
 	/* remove trailing songs */
 
 	unsigned length = mpd_status_get_queue_length(status);
-	while (length < playlist.size()) {
-		/* Remove the last playlist entry */
-		playlist.RemoveIndex(playlist.size() - 1);
-	}
+	if (length < playlist.size())
+		playlist.RemoveRange(length, playlist.size());
 
 	current_song = nullptr;
 	playlist.version = mpd_status_get_queue_version(status);
 
-	return FinishCommand();
+	return FinishCommand(perf_stats.queue_latency);
 }
@@ -23,6 +23,7 @@
 #include "config.h"
 #include "Queue.hxx"
 #include "gidle.hxx"
+#include "PerfStats.hxx"
 #include "util/Compiler.h"
 #include "AsioServiceFwd.hxx"
 
@@ -39,10 +40,144 @@
 
 #include <boost/asio/steady_timer.hpp>
 
+#include <chrono>
 #include <string>
+#include <utility>
+#include <vector>
 
 struct AsyncMpdConnect;
 
+/**
+ * Receives the entities of a response which is received in portions
+ * from the main loop (see mpdclient::ReceiveEntitiesAsync()).
+ */
+class MpdEntityHandler {
+public:
+	/**
+	 * Decide whether the entity beginning with the given pair
+	 * shall be received.  If not, its pairs are skipped without
+	 * allocating an entity object.
+	 */
+	virtual bool AcceptEntity(gcc_unused const struct mpd_pair &pair) noexcept {
+		return true;
+	}
+
+	/**
+	 * An entity has been received.  The handler takes ownership.
+	 */
+	virtual void OnEntity(struct mpd_entity &entity) noexcept = 0;
+
+	/**
+	 * A portion of the response has been received; this is a
+	 * good time to repaint.
+	 */
+	virtual void OnEntityPortion() noexcept = 0;
+
+	/**
+	 * The response is complete.
+	 *
+	 * @param success false if the command has failed (the error
+	 * has already been reported)
+	 */
+	virtual void OnEntityEnd(bool success) noexcept = 0;
+};
+
+/**
+ * Counters describing how idle events were coalesced (see
+ * mpdclient::OnIdle()).
+ */
+struct IdleStatistics {
+	/**
+	 * The number of idle responses received from MPD.
+	 */
+	unsigned long received = 0;
+
+	/**
+	 * The number of idle responses which were merged into a
+	 * coalescing window instead of being handled right away.
+	 */
+	unsigned long coalesced = 0;
+
+	/**
+	 * The number of coalescing windows which were opened.
+	 */
+	unsigned long windows = 0;
+
+	/**
+	 * The number of times idle events were handled, i.e. the
+	 * number of Update() calls and screen refreshes they caused.
+	 */
+	unsigned long handled = 0;
+};
+
+/**
+ * A queue edit which has already been applied to the local
+ * #MpdQueue copy, but which MPD has not confirmed yet.  It contains
+ * everything needed to undo the edit if MPD rejects the command.
+ */
+struct PendingQueueEdit {
+	enum class Type {
+		NONE,
+
+		/**
+		 * A song was appended at #position.
+		 */
+		ADD,
+
+		/**
+		 * The songs in #removed were deleted at #position.
+		 */
+		DELETE,
+
+		/**
+		 * The song at #position was moved to #dest.
+		 */
+		MOVE,
+
+		/**
+		 * The songs starting at #position were rearranged
+		 * according to #order (see MpdQueue::Reorder()).
+		 */
+		REORDER,
+
+		/**
+		 * The songs in #removed were deleted from the
+		 * (ascending) positions listed in #order.
+		 */
+		DELETE_LIST,
+	};
+
+	Type type = Type::NONE;
+
+	unsigned position, dest;
+
+	/**
+	 * The queue length MPD is expected to report after
+	 * executing the command.
+	 */
+	unsigned expected_length;
+
+	/**
+	 * The queue version MPD is expected to report after
+	 * executing the command.
+	 */
+	unsigned expected_version;
+
+	std::vector<MpdQueue::Item> removed;
+
+	std::vector<unsigned> order;
+
+	bool IsDefined() const noexcept {
+		return type != Type::NONE;
+	}
+
+	void Clear() noexcept {
+		type = Type::NONE;
+		removed.clear();
+		order.clear();
+	}
+};
+
 struct mpdclient final
 	: MpdIdleHandler
 #ifdef ENABLE_ASYNC_CONNECT
@@ -77,6 +212,24 @@ struct mpdclient final
 	/* playlist */
 	MpdQueue playlist;
 
+	/**
+	 * A queue edit which was sent to MPD, but whose response has
+	 * not been received yet.  The response is received right
+	 * before the connection is used again (see GetConnection()),
+	 * or before entering idle mode; this way, the screen gets
+	 * painted while the command is still in flight.
+	 */
+	PendingQueueEdit pending_edit;
+
+	/**
+	 * The handler of a response which is being received in
+	 * portions (see ReceiveEntitiesAsync()).  It is nullptr if
+	 * there is no such response or if the handler has canceled
+	 * it; in the latter case, the rest of the response is
+	 * discarded.
+	 */
+	MpdEntityHandler *entity_handler = nullptr;
+
 #ifdef ENABLE_ASYNC_CONNECT
 	AsyncMpdConnect *async_connect = nullptr;
 #endif
@@ -102,12 +255,53 @@ struct mpdclient final
 	 */
 	boost::asio::steady_timer enter_idle_timer;
 
+	/**
+	 * If idle events arrive faster than #IDLE_BURST_THRESHOLD,
+	 * they are collected in #burst_events until this timer
+	 * expires, and then handled all at once.
+	 */
+	boost::asio::steady_timer idle_burst_timer;
+
+	/**
+	 * Receives the next portion of an entity response (see
+	 * ReceiveEntitiesAsync()).
+	 */
+	boost::asio::steady_timer receive_entities_timer;
+
+	/**
+	 * The time the most recent idle event was received.
+	 */
+	std::chrono::steady_clock::time_point last_idle_time;
+
+	/**
+	 * The duration of the next coalescing window.  It grows
+	 * while a burst continues, and is reset to
+	 * #IDLE_BURST_MIN_WINDOW after a quiet period.
+	 */
+	std::chrono::steady_clock::duration idle_burst_window;
+
+	IdleStatistics idle_statistics;
+
+	/**
+	 * When GetConnection() has handed out the connection for the
+	 * current command; only set while #perf_stats is enabled.
+	 * FinishCommand() uses it to measure the round trip time.
+	 */
+	std::chrono::steady_clock::time_point command_start;
+
 	/**
 	 * This attribute is incremented whenever the connection changes
 	 * (i.e. on disconnection and (re-)connection).
 	 */
 	unsigned connection_id = 0;
 
+	/**
+	 * This attribute is incremented whenever MPD reports a change
+	 * of the database or the stored playlists.  Caches compare it
+	 * to find out whether they are outdated.
+	 */
+	unsigned database_serial = 0;
+
 	int volume = -1;
 
 	/**
@@ -115,6 +309,12 @@ struct mpdclient final
 	 */
 	unsigned events = 0;
 
+	/**
+	 * A bit mask of idle events collected in the current
+	 * coalescing window (see #idle_burst_timer).
+	 */
+	unsigned burst_events = 0;
+
 	enum mpd_state state = MPD_STATE_UNKNOWN;
 
 #ifdef HAVE_TAG_WHITELIST
@@ -132,6 +332,17 @@ struct mpdclient final
 	 */
 	bool idle = false;
 
+	/**
+	 * Is #idle_burst_timer currently pending?
+	 */
+	bool idle_burst_pending = false;
+
+	/**
+	 * Is an entity response being received in portions (see
+	 * ReceiveEntitiesAsync())?
+	 */
+	bool receiving_entities = false;
+
 	/**
 	 * Is MPD currently playing?
 	 */
@@ -210,6 +421,15 @@ struct mpdclient final
 			;
 	}
 
+	/**
+	 * Is MPD currently updating its database?
+	 */
+	gcc_pure
+	bool IsUpdatingDatabase() const noexcept {
+		return status != nullptr &&
+			mpd_status_get_update_id(status) != 0;
+	}
+
 	gcc_pure
 	int GetCurrentSongId() const noexcept {
 		return status != nullptr
@@ -260,18 +480,43 @@ struct mpdclient final
 	struct mpd_connection *GetConnection();
 
 	bool FinishCommand() {
-		return mpd_response_finish(connection) || HandleError();
+		return FinishCommand(perf_stats.command_latency);
+	}
+
+	/**
+	 * Receive the response of the command which was just sent in
+	 * portions from the main loop, and pass its entities to the
+	 * given handler.  Until the response is complete, the
+	 * connection is busy; GetConnection() receives the rest of it
+	 * synchronously.
+	 */
+	void ReceiveEntitiesAsync(MpdEntityHandler &handler) noexcept;
+
+	/**
+	 * Cancel ReceiveEntitiesAsync(); the handler will not be
+	 * invoked again, and the rest of the response is discarded in
+	 * the background.
+	 */
+	void CancelReceiveEntities(MpdEntityHandler &handler) noexcept {
+		if (entity_handler == &handler)
+			entity_handler = nullptr;
 	}
 
 	bool Update();
 
+	/**
+	 * Is an entity response being received in portions (see
+	 * ReceiveEntitiesAsync())?
+	 */
+	bool IsReceivingEntities() const noexcept {
+		return receiving_entities;
+	}
+
 	bool OnConnected(struct mpd_connection *_connection) noexcept;
 
 	const struct mpd_status *ReceiveStatus() noexcept;
 
 	bool RunVolume(unsigned new_volume) noexcept;
-	bool RunVolumeUp() noexcept;
-	bool RunVolumeDown() noexcept;
 
 	bool RunClearQueue() noexcept;
 	bool RunAdd(const struct mpd_song &song) noexcept;
@@ -279,6 +524,23 @@ struct mpdclient final
 	bool RunDeleteRange(unsigned start, unsigned end) noexcept;
 	bool RunMove(unsigned dest, unsigned src) noexcept;
 
+	/**
+	 * Rearrange the songs in the queue range [start,
+	 * start+order.size()) with a minimal list of "move" commands
+	 * (see MpdQueue::Reorder() and PlanQueueMoves()).
+	 */
+	bool RunReorder(unsigned start,
+			const std::vector<unsigned> &order) noexcept;
+
+	/**
+	 * Delete all songs whose URI occurs more than once in the
+	 * queue, keeping the first occurrence (or the one being
+	 * played).
+	 *
+	 * @return the number of deleted songs, or -1 on error
+	 */
+	int RunDeleteDuplicates() noexcept;
+
 private:
 #ifdef ENABLE_ASYNC_CONNECT
 	void StartConnect(const struct mpd_settings &s) noexcept;
@@ -286,9 +548,45 @@ private:
 
 	void InvokeErrorCallback() noexcept;
 
+	/**
+	 * Like FinishCommand(), but add the round trip time to the
+	 * given #Histogram.
+	 */
+	bool FinishCommand(Histogram &latency) {
+		const bool success = mpd_response_finish(connection) ||
+			HandleError();
+		RecordCommandLatency(latency);
+		return success;
+	}
+
+	/**
+	 * Add the time since GetConnection() to the given
+	 * #Histogram (if #perf_stats is enabled).
+	 */
+	void RecordCommandLatency(Histogram &latency) noexcept {
+		if (command_start != std::chrono::steady_clock::time_point())
+			latency.Add(std::chrono::steady_clock::now() -
+				    std::exchange(command_start,
+						  std::chrono::steady_clock::time_point()));
+	}
+
 	bool UpdateQueue();
 	bool UpdateQueueChanges();
 
+	/**
+	 * Receive the response for #pending_edit and reconcile the
+	 * local queue copy with it.
+	 *
+	 * @return false if MPD has rejected the command and the edit
+	 * was rolled back
+	 */
+	bool FinishQueueEdit() noexcept;
+
+	/**
+	 * Undo the given edit in the local queue copy.
+	 */
+	void RollbackQueueEdit(PendingQueueEdit &edit) noexcept;
+
 	void ClearStatus() noexcept;
 
 	void ScheduleEnterIdle() noexcept;
@@ -297,6 +595,33 @@ private:
 	}
 	void OnEnterIdleTimer(const boost::system::error_code &error) noexcept;
 
+	/**
+	 * Receive up to the given number of entities of the pending
+	 * entity response (0 means unlimited).
+	 *
+	 * @return true if the response is complete
+	 */
+	bool ReceiveEntities(unsigned max) noexcept;
+
+	void ScheduleReceiveEntities() noexcept;
+
+	/**
+	 * Receive the next portion of the pending entity response.
+	 * This is invoked by #receive_entities_timer, and for the
+	 * first portion by MpdIdleSource::AsyncWaitResponse().
+	 */
+	void OnReceiveEntitiesTimer(const boost::system::error_code &error) noexcept;
+
+	void ScheduleIdleBurstTimer() noexcept;
+	void CancelIdleBurstTimer() noexcept;
+	void OnIdleBurstTimer(const boost::system::error_code &error) noexcept;
+
+	/**
+	 * Handle the idle events collected in #events: update the
+	 * status and the queue, and notify the application.
+	 */
+	void HandleIdleEvents() noexcept;
+
 #ifdef ENABLE_ASYNC_CONNECT
 	/* virtual methods from AsyncMpdConnectHandler */
 	void OnAsyncMpdConnect(struct mpd_connection *c) noexcept override;
@@ -19,6 +19,7 @@
 
 #include "player_command.hxx"
 #include "DelayedSeek.hxx"
+#include "DelayedVolume.hxx"
 #include "Command.hxx"
 #include "mpdclient.hxx"
 #include "Options.hxx"
@@ -27,7 +28,8 @@
 #include "screen_status.hxx"
 
 bool
-handle_player_command(struct mpdclient &c, DelayedSeek &seek, Command cmd)
+handle_player_command(struct mpdclient &c, DelayedSeek &seek,
+		      DelayedVolume &volume, Command cmd)
 {
 	if (!c.IsConnected() || c.status == nullptr)
 		return false;
@@ -149,10 +151,10 @@ handle_player_command(struct mpdclient &c, DelayedSeek &seek, Command cmd)
 		screen_database_update(&c, nullptr);
 		break;
 	case Command::VOLUME_UP:
-		c.RunVolumeUp();
+		volume.Change(1);
 		break;
 	case Command::VOLUME_DOWN:
-		c.RunVolumeDown();
+		volume.Change(-1);
 		break;
 
 	default:
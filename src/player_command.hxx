@@ -23,8 +23,10 @@
 enum class Command : unsigned;
 struct mpdclient;
 class DelayedSeek;
+class DelayedVolume;
 
 bool
-handle_player_command(struct mpdclient &c, DelayedSeek &seek, Command cmd);
+handle_player_command(struct mpdclient &c, DelayedSeek &seek,
+		      DelayedVolume &volume, Command cmd);
 
 #endif
@@ -39,29 +39,26 @@ class PlaylistNameCompletion final : public Completion {
 
 public:
 	explicit PlaylistNameCompletion(struct mpdclient &_c) noexcept
-		:c(_c) {}
+		:Completion(GetPlaylistCompletionList(_c)), c(_c) {}
 
 protected:
 	/* virtual methods from class Completion */
 	void Pre(const char *value) noexcept override;
-	void Post(const char *value, Range range) noexcept override;
+	void Post(const char *value, const Range &range) noexcept override;
 };
 
 void
 PlaylistNameCompletion::Pre(gcc_unused const char *value) noexcept
 {
-	if (empty()) {
-		/* create completion list */
-		gcmp_list_from_path(&c, "", *this, GCMP_TYPE_PLAYLIST);
-	}
+	/* create completion list (unless already loaded) */
+	LoadPlaylistCompletion(c);
 }
 
 void
 PlaylistNameCompletion::Post(gcc_unused const char *value,
-			     Range range) noexcept
+			     const Range &range) noexcept
 {
-	if (range.begin() != range.end() &&
-	    std::next(range.begin()) != range.end())
+	if (range.size() > 1)
 		screen_display_completion_list(range);
 }
 
@@ -28,6 +28,7 @@
 #include "mpdclient.hxx"
 #include "Options.hxx"
 #include "DelayedSeek.hxx"
+#include "DelayedVolume.hxx"
 #include "player_command.hxx"
 #include "SongPage.hxx"
 #include "LyricsPage.hxx"
@@ -129,7 +130,8 @@ ScreenManager::NextMode(struct mpdclient &c, int offset) noexcept
 }
 
 void
-ScreenManager::Update(struct mpdclient &c, const DelayedSeek &seek) noexcept
+ScreenManager::Update(struct mpdclient &c, const DelayedSeek &seek,
+		      const DelayedVolume &volume) noexcept
 {
 	const unsigned events = c.events;
 
@@ -199,7 +201,7 @@ ScreenManager::Update(struct mpdclient &c, const DelayedSeek &seek) noexcept
 	was_connected = c.IsConnected();
 #endif
 
-	title_bar.Update(c.status);
+	title_bar.Update(c.status, volume);
 
 	unsigned elapsed;
 	if (c.status == nullptr)
@@ -227,12 +229,13 @@ ScreenManager::Update(struct mpdclient &c, const DelayedSeek &seek) noexcept
 }
 
 void
-ScreenManager::OnCommand(struct mpdclient &c, DelayedSeek &seek, Command cmd)
+ScreenManager::OnCommand(struct mpdclient &c, DelayedSeek &seek,
+			 DelayedVolume &volume, Command cmd)
 {
 	if (current_page->second->OnCommand(c, cmd))
 		return;
 
-	if (handle_player_command(c, seek, cmd))
+	if (handle_player_command(c, seek, volume, cmd))
 		return;
 
 	const auto *new_page = PageByCommand(cmd);
@@ -276,6 +279,7 @@ ScreenManager::OnCommand(struct mpdclient &c, DelayedSeek &seek, Command cmd)
 
 bool
 ScreenManager::OnMouse(struct mpdclient &c, DelayedSeek &seek,
+		       DelayedVolume &volume,
 		       Point p, mmask_t bstate)
 {
 	if (current_page->second->OnMouse(c, p - GetMainPosition(),
@@ -284,7 +288,7 @@ ScreenManager::OnMouse(struct mpdclient &c, DelayedSeek &seek,
 
 	/* if button 2 was pressed switch screen */
 	if (bstate & BUTTON2_CLICKED) {
-		OnCommand(c, seek, Command::SCREEN_NEXT);
+		OnCommand(c, seek, volume, Command::SCREEN_NEXT);
 		return true;
 	}
 
@@ -43,6 +43,7 @@ struct mpdclient;
 struct PageMeta;
 class Page;
 class DelayedSeek;
+class DelayedVolume;
 
 class ScreenManager {
 	boost::asio::io_service &io_service;
@@ -135,11 +136,14 @@ public:
 	void PaintTopWindow() noexcept;
 	void Paint(bool main_dirty) noexcept;
 
-	void Update(struct mpdclient &c, const DelayedSeek &seek) noexcept;
-	void OnCommand(struct mpdclient &c, DelayedSeek &seek, Command cmd);
+	void Update(struct mpdclient &c, const DelayedSeek &seek,
+		    const DelayedVolume &volume) noexcept;
+	void OnCommand(struct mpdclient &c, DelayedSeek &seek,
+		       DelayedVolume &volume, Command cmd);
 
 #ifdef HAVE_GETMOUSE
 	bool OnMouse(struct mpdclient &c, DelayedSeek &seek,
+		     DelayedVolume &volume,
 		     Point p, mmask_t bstate);
 #endif
 
@@ -22,6 +22,10 @@
 #include "screen_status.hxx"
 #include "screen.hxx"
 #include "ListWindow.hxx"
+#include "IncrementalJump.hxx"
+#include "FuzzyFinder.hxx"
+#include "Match.hxx"
+#include "ListTextCache.hxx"
 #include "AsyncUserInput.hxx"
 #include "i18n.h"
 #include "Command.hxx"
@@ -33,6 +37,11 @@
 #define FIND_PROMPT  _("Find")
 #define RFIND_PROMPT _("Find backward")
 #define JUMP_PROMPT _("Jump")
+#define FUZZY_PROMPT _("Fuzzy find")
+#define FILTER_PROMPT _("Filter")
+
+#define KEY_CTRL_N 14
+#define KEY_CTRL_P 16
 
 /* query user for a string and find it in a list window */
 bool
@@ -106,6 +115,9 @@ screen_jump(ScreenManager &screen, ListWindow &lw,
 	char *search_str = buffer + snprintf(buffer, WRLN_MAX_LINE_SIZE, "%s: ", JUMP_PROMPT);
 	char *iter = search_str;
 
+	const FoldedListTexts keys(text, lw.GetLength());
+	IncrementalJump incremental(*keys, options.jump_prefix_only);
+
 	while(1) {
 		key = screen_getch(buffer);
 		/* if backspace or delete was pressed, process instead of ending loop */
@@ -124,7 +136,12 @@ screen_jump(ScreenManager &screen, ListWindow &lw,
 			*iter++ = key;
 			*iter = '\0';
 		}
-		lw.Jump(text, search_str);
+		if (IncrementalJump::CanNarrow(search_str)) {
+			const int i = incremental.Find(search_str);
+			if (i >= 0)
+				lw.MoveCursor(i);
+		} else
+			lw.Jump(text, search_str);
 
 		/* repaint the list_window */
 		lw.Paint(renderer);
@@ -136,3 +153,83 @@ screen_jump(ScreenManager &screen, ListWindow &lw,
 	/* ncmpc should get the command */
 	keyboard_unread(screen.get_io_service(), key);
 }
+
+void
+screen_fuzzy_find(ListWindow &lw,
+		  const ListText &text,
+		  const ListRenderer &renderer) noexcept
+{
+	const FoldedListTexts keys(text, lw.GetLength());
+	FuzzyFinder finder(*keys);
+
+	char buffer[1024];
+	char *const pattern = buffer + snprintf(buffer, sizeof(buffer),
+						"%s: ", FUZZY_PROMPT);
+	char *iter = pattern;
+
+	std::vector<unsigned> items;
+	size_t selected = 0;
+	bool update = true;
+
+	while (true) {
+		if (update) {
+			/* show as many results as fit on the screen */
+			const auto results = finder.Find(pattern,
+							 lw.GetHeight());
+			items.clear();
+			for (const auto &i : results)
+				items.push_back(i.index);
+
+			selected = 0;
+			update = false;
+		}
+
+		lw.PaintItems(renderer, items, selected);
+		lw.Refresh();
+
+		const int key = screen_getch(buffer);
+		if (key == KEY_BACKSPACE || key == KEY_DC) {
+			const char *prev = PrevCharMB(buffer, iter);
+			if (pattern <= prev)
+				iter = const_cast<char *>(prev);
+			*iter = '\0';
+			update = true;
+		} else if (key == KEY_UP || key == KEY_CTRL_P) {
+			if (selected > 0)
+				--selected;
+		} else if (key == KEY_DOWN || key == KEY_CTRL_N) {
+			if (selected + 1 < items.size())
+				++selected;
+		} else if (key == '\r' || key == '\n' || key == KEY_ENTER) {
+			if (selected < items.size())
+				lw.MoveCursor(items[selected]);
+			break;
+		} else if (key == ERR || key > 0xff || iscntrl(key)) {
+			/* cancel */
+			break;
+		} else if (iter < buffer + sizeof(buffer) - 3) {
+			*iter++ = key;
+			*iter = '\0';
+			update = true;
+		}
+	}
+}
+
+bool
+screen_read_filter(ScreenManager &screen, std::string &pattern) noexcept
+{
+	auto value = screen_readln(FILTER_PROMPT, pattern.c_str(),
+				   &screen.find_history, nullptr);
+	if (value == pattern)
+		return false;
+
+	if (!value.empty() &&
+	    GetMatchExpression(value.c_str(), false) == nullptr) {
+		screen_status_printf(_("Invalid filter: %s"), value.c_str());
+		screen_bell();
+		return false;
+	}
+
+	pattern = std::move(value);
+	return true;
+}
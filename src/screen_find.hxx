@@ -20,6 +20,8 @@
 #ifndef NCMPC_SCREEN_FIND_H
 #define NCMPC_SCREEN_FIND_H
 
+#include <string>
+
 enum class Command : unsigned;
 class ScreenManager;
 class ListWindow;
@@ -46,4 +48,24 @@ void
 screen_jump(ScreenManager &screen, ListWindow &lw,
 	    const ListText &text, const ListRenderer &renderer) noexcept;
 
+/**
+ * Query the user for a pattern and show the items which match it
+ * best as a subsequence (see #FuzzyFinder) while the user types.
+ * Up/down choose one of them, and Enter moves the cursor to it.
+ */
+void
+screen_fuzzy_find(ListWindow &lw,
+		  const ListText &text, const ListRenderer &renderer) noexcept;
+
+/**
+ * Query the user for a new filter pattern (see #ListFilter).  An
+ * empty pattern disables the filter.
+ *
+ * @param pattern the current pattern, which gets replaced
+ * @return true if the pattern has been changed, false if it is
+ * unchanged or malformed
+ */
+bool
+screen_read_filter(ScreenManager &screen, std::string &pattern) noexcept;
+
 #endif
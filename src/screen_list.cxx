@@ -28,6 +28,7 @@
 #include "KeyDefPage.hxx"
 #include "LyricsPage.hxx"
 #include "OutputsPage.hxx"
+#include "PerfPage.hxx"
 #include "ChatPage.hxx"
 #include "util/Macros.hxx"
 #include "config.h"
@@ -52,6 +53,9 @@ static const PageMeta *const screens[] = {
 #ifdef ENABLE_OUTPUTS_SCREEN
 	&screen_outputs,
 #endif
+#ifdef ENABLE_PERF_SCREEN
+	&screen_perf,
+#endif
 #ifdef ENABLE_CHAT_SCREEN
 	&screen_chat,
 #endif
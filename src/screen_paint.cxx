@@ -20,6 +20,7 @@
 #include "screen.hxx"
 #include "Page.hxx"
 #include "Options.hxx"
+#include "PerfStats.hxx"
 
 #include <assert.h>
 
@@ -35,6 +36,13 @@ ScreenManager::PaintTopWindow() noexcept
 void
 ScreenManager::Paint(bool main_dirty) noexcept
 {
+	const bool measure = perf_stats.enabled;
+	std::chrono::steady_clock::time_point start;
+	if (measure)
+		start = std::chrono::steady_clock::now();
+
+	perf_stats.frame_rows_painted = 0;
+
 	/* update title/header window */
 	PaintTopWindow();
 
@@ -61,4 +69,10 @@ ScreenManager::Paint(bool main_dirty) noexcept
 
 	/* tell curses to update */
 	doupdate();
+
+	if (measure) {
+		perf_stats.paint_duration.Add(std::chrono::steady_clock::now() - start);
+		++perf_stats.frames;
+		perf_stats.rows_painted += perf_stats.frame_rows_painted;
+	}
 }
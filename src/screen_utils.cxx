@@ -183,21 +183,19 @@ CompletionDisplayString(const char *value) noexcept
 }
 
 void
-screen_display_completion_list(Completion::Range range) noexcept
+screen_display_completion_list(const Completion::Range &range) noexcept
 {
 	static Completion::Range prev_range;
-	static size_t prev_length = 0;
 	static unsigned offset = 0;
 	WINDOW *w = screen->main_window.w;
 
-	size_t length = std::distance(range.begin(), range.end());
-	if (range == prev_range && length == prev_length) {
+	const size_t length = range.size();
+	if (range == prev_range) {
 		offset += screen->main_window.size.height;
 		if (offset >= length)
 			offset = 0;
 	} else {
 		prev_range = range;
-		prev_length = length;
 		offset = 0;
 	}
 
@@ -49,6 +49,6 @@ screen_readln(const char *prompt, const char *value,
 	      History *history, Completion *completion) noexcept;
 
 void
-screen_display_completion_list(Completion::Range range) noexcept;
+screen_display_completion_list(const Completion::Range &range) noexcept;
 
 #endif
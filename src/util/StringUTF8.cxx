@@ -69,3 +69,38 @@ CollateUTF8(const char *a, const char *b)
 
 	return strcoll(a, b);
 }
+
+static size_t
+TransformUTF8(char *dest, const char *src, size_t n) noexcept
+{
+#ifdef HAVE_LOCALE_T
+	if (utf8_locale != locale_t(0))
+		return strxfrm_l(dest, src, n, utf8_locale);
+#endif
+
+	return strxfrm(dest, src, n);
+}
+
+std::string
+CollateKeyUTF8(const char *s) noexcept
+{
+	std::string key;
+
+	/* the result is usually a few times longer than the
+	   source */
+	size_t size = strlen(s) * 4 + 1;
+	while (true) {
+		key.resize(size);
+		const size_t length = TransformUTF8(&key.front(), s, size);
+		if (length == size_t(-1))
+			/* invalid input; fall back to the raw bytes */
+			return s;
+
+		if (length < size) {
+			key.resize(length);
+			return key;
+		}
+
+		size = length + 1;
+	}
+}
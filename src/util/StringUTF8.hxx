@@ -23,6 +23,8 @@
 #include "config.h"
 #include "Compiler.h"
 
+#include <string>
+
 class ScopeInitUTF8 {
 #ifdef HAVE_LOCALE_T
 public:
@@ -38,4 +40,13 @@ gcc_pure
 int
 CollateUTF8(const char *a, const char *b);
 
+/**
+ * Transform a UTF-8 string (see strxfrm()).  Comparing two
+ * transformed strings with strcmp() has the same result as comparing
+ * the original strings with CollateUTF8().
+ */
+gcc_pure
+std::string
+CollateKeyUTF8(const char *s) noexcept;
+
 #endif